@@ -1,6 +1,7 @@
 #include "li.h"
 #include "li_lib.h"
 
+#include <sys/resource.h>
 #include <time.h>
 
 static li_object *p_rand(li_object *args)
@@ -41,9 +42,25 @@ static li_object *p_system(li_object *args)
     return (li_object *)li_num_with_int(system(cmd));
 }
 
+/*
+ * (max-rss)
+ * Returns the peak resident set size of the process in kilobytes.
+ */
+static li_object *p_max_rss(li_object *args)
+{
+    struct rusage usage;
+    li_parse_args(args, "");
+    getrusage(RUSAGE_SELF, &usage);
+#if defined(__APPLE__)
+    usage.ru_maxrss /= 1024;
+#endif
+    return (li_object *)li_num_with_int(usage.ru_maxrss);
+}
+
 extern void lilib_load(li_env_t *env)
 {
     srand(time(NULL));
+    lilib_defproc(env, "max-rss", p_max_rss);
     lilib_defproc(env, "rand", p_rand);
     lilib_defproc(env, "remove", p_remove);
     lilib_defproc(env, "rename", p_rename);
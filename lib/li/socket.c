@@ -1,6 +1,7 @@
 #include "li.h"
 #include "li_lib.h"
 
+#include <errno.h> /* errno */
 #include <netdb.h> /* struct hostent, gethostbyname */
 #include <netinet/in.h> /* struct sockaddr_in, struct sockaddr */
 #include <string.h> /* memcpy, memset */
@@ -15,9 +16,23 @@ typedef struct {
     struct sockaddr_in addr;
 } li_socket_t;
 
+/* Runs a full collection to close unreachable sockets if fds ran out. */
+static int socket_open(int domain, int type, int protocol)
+{
+    int fd = socket(domain, type, protocol);
+    if (fd < 0 && li_gc_reclaim_fds(errno))
+        fd = socket(domain, type, protocol);
+    return fd;
+}
+
+/* Safe to call twice: the collector closes whatever is left open. */
 static void socket_close(li_object *obj)
 {
-    close(((li_socket_t *)obj)->fd);
+    li_socket_t *sock = (li_socket_t *)obj;
+    if (sock->fd >= 0) {
+        close(sock->fd);
+        sock->fd = -1;
+    }
 }
 
 const li_type_t li_type_socket = {
@@ -31,19 +46,23 @@ static li_object *p_make_client_socket(li_object *args)
     li_socket_t *sock;
     li_str_t *node, *service;
     struct hostent *hostent;
+    int fd;
     int ai_family = AF_INET,
         ai_socktype = SOCK_STREAM,
         ai_flags = AI_V4MAPPED | AI_ADDRCONFIG, /* TODO: use these flags */
         ai_protocol = IPPROTO_IP;
     li_parse_args(args, "ss?iiii", &node, &service,
             &ai_family, &ai_socktype, &ai_flags, &ai_protocol);
+    fd = socket_open(ai_family, ai_socktype, ai_protocol);
+    if (fd < 0)
+        li_error_fmt("ERROR opening socket");
     hostent = gethostbyname(li_string_bytes(node));
-    if (hostent == NULL)
+    if (hostent == NULL) {
+        close(fd);
         li_error_fmt("bad host: ~a", node);
+    }
     sock = (li_socket_t *)li_create(&li_type_socket);
-    sock->fd = socket(ai_family, ai_socktype, ai_protocol);
-    if (sock->fd < 0)
-        li_error_fmt("ERROR opening socket");
+    sock->fd = fd;
     /* init address */
     sock->addr.sin_family = ai_family;
     sock->addr.sin_port = htons(atoi(li_string_bytes(service)));
@@ -60,14 +79,16 @@ static li_object *p_make_server_socket(li_object *args)
 {
     li_socket_t *sock;
     li_str_t *service;
+    int fd;
     int ai_family = AF_INET,
         ai_socktype = SOCK_STREAM,
         ai_protocol = IPPROTO_IP;
     li_parse_args(args, "s?iii", &service, &ai_family, &ai_socktype, &ai_protocol);
-    sock = (li_socket_t *)li_create(&li_type_socket);
-    sock->fd = socket(ai_family, ai_socktype, ai_protocol);
-    if (sock->fd < 0)
+    fd = socket_open(ai_family, ai_socktype, ai_protocol);
+    if (fd < 0)
         li_error_fmt("ERROR opening socket");
+    sock = (li_socket_t *)li_create(&li_type_socket);
+    sock->fd = fd;
     /* init address */
     memset(&sock->addr, 0, sizeof(sock->addr));
     sock->addr.sin_family = ai_family;
@@ -96,6 +117,12 @@ static li_object *p_socket_accept(li_object *args)
     len = sizeof(sock->addr);
     /* listen(sock->fd, 5); */
     fd = accept(sock->fd, (struct sockaddr *)&sock->addr, &len);
+    if (fd < 0 && li_gc_reclaim_fds(errno)) {
+        len = sizeof(sock->addr);
+        fd = accept(sock->fd, (struct sockaddr *)&sock->addr, &len);
+    }
+    if (fd < 0)
+        li_error_fmt("ERROR on accept");
     sock = (li_socket_t *)li_create(&li_type_socket);
     sock->fd = fd;
     return (li_object *)sock;
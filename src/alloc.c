@@ -0,0 +1,849 @@
+#define _POSIX_C_SOURCE 200112L /* posix_memalign */
+
+#include "li.h"
+#include "li_gc.h"
+
+#include <stdlib.h> /* posix_memalign */
+#include <string.h> /* memset */
+
+/*
+ * Objects live in pages of LI_PAGE_SIZE bytes.  Every page is carved into
+ * slots of a single size class, which is the size of the object's type rounded
+ * up to a multiple of LI_SLOT_ALIGN.  Slots are handed out by bumping a pointer
+ * through a fresh page and, once a sweep has reclaimed some of them, from the
+ * page's free list.  Objects too big for any size class get a page of their
+ * own.  A slot which does not hold an object has a NULL type, which is how a
+ * sweep tells the two apart without any registry of allocated objects.
+ *
+ * Pages are aligned to their size, so the page of an object is found by
+ * masking its address.  Per object bits (whether it is marked, whether it is
+ * old and whether it is in the remembered set) are kept in bitmaps in the page
+ * header, indexed by the object's offset in units of LI_SLOT_ALIGN.  Marking
+ * thus never writes to the objects themselves, which keeps the pages of a
+ * forked process shared with its parent until the mutator touches them.
+ *
+ * Objects are born young.  Every page which received an object since the last
+ * collection is on the nursery list, which is all a minor collection needs to
+ * sweep.  Objects surviving a collection are promoted in place by setting
+ * their old bit.
+ *
+ * While a region is open, small objects are only bumped out of fresh pages set
+ * aside for it and big ones get region pages of their own.  Every store into
+ * an object from outside the region is remembered, young or old, so that once
+ * the region ends the objects which escaped it are found by marking from the
+ * roots and the remembered set without looking at anything else.  The rest of
+ * the region is destroyed and its empty pages freed in one go.
+ */
+
+#define LI_PAGE_SIZE    (64 * 1024)
+#define LI_SLOT_ALIGN   8
+#define LI_SLOT_MIN     16
+#define LI_SLOT_MAX     256
+#define LI_NUM_CLASSES  (LI_SLOT_MAX / LI_SLOT_ALIGN)
+#define LI_PAGE_BITS    (LI_PAGE_SIZE / LI_SLOT_ALIGN)
+
+typedef struct li_page_t li_page_t;
+typedef struct li_free_t li_free_t;
+
+struct li_free_t {
+    const li_type_t *type;
+    li_free_t *next;
+};
+
+struct li_page_t {
+    li_page_t *next;
+    li_page_t *prev;
+    li_page_t *young_next;  /* next page on the nursery list */
+    li_bool_t young;        /* whether the page is on the nursery list */
+    size_t size;            /* size of each slot */
+    char *bump;             /* first slot which was never handed out */
+    char *end;              /* end of the last slot */
+    li_free_t *free;        /* slots reclaimed by the last sweep */
+    size_t live;            /* objects left by the last sweep */
+    li_bool_t pending;      /* whether the sweep left dead objects behind */
+    li_bool_t region;       /* whether the page belongs to the open region */
+    li_byte_t marked[LI_PAGE_BITS / 8];
+    li_byte_t old[LI_PAGE_BITS / 8];
+    li_byte_t remembered[LI_PAGE_BITS / 8];
+};
+
+#define LI_PAGE_HEAD \
+    ((sizeof(li_page_t) + LI_SLOT_ALIGN - 1) & ~(size_t)(LI_SLOT_ALIGN - 1))
+#define li_page_slots(page)     ((char *)(page) + LI_PAGE_HEAD)
+#define li_page_of(obj) \
+    ((li_page_t *)((size_t)(obj) & ~(size_t)(LI_PAGE_SIZE - 1)))
+#define li_page_bytes(page) \
+    ((page)->size > LI_SLOT_MAX ? LI_PAGE_HEAD + (page)->size : LI_PAGE_SIZE)
+#define li_page_bit(page, obj) \
+    ((size_t)((char *)(obj) - (char *)(page)) / LI_SLOT_ALIGN)
+
+#define li_bit_get(bits, i)     ((bits)[(i) / 8] & (1 << ((i) % 8)))
+#define li_bit_set(bits, i)     ((bits)[(i) / 8] |= (1 << ((i) % 8)))
+#define li_bit_clear(bits, i)   ((bits)[(i) / 8] &= ~(1 << ((i) % 8)))
+
+static struct {
+    li_page_t *pages;
+    li_page_t *cursor;  /* the page slots are currently taken from */
+} _classes[LI_NUM_CLASSES];
+
+static li_page_t *_large = NULL;
+
+static li_page_t *_nursery = NULL;
+
+/*
+ * Every page, in an open addressing hash table, to tell heap objects from
+ * static ones.
+ */
+static struct {
+    li_page_t **table;
+    size_t cap;
+    size_t size;
+    size_t bytes;
+} _pages = { NULL, 0, 0, 0 };
+
+/* Old objects which were written to since the last collection. */
+static struct {
+    li_object **objs;
+    size_t size;
+    size_t cap;
+} _remembered = { NULL, 0, 0 };
+
+/* Every page, while a full sweep is in progress. */
+static struct {
+    li_page_t **pages;
+    size_t size;
+    size_t cap;
+} _sweep = { NULL, 0, 0 };
+
+static size_t _allocated = 0;
+
+/* Objects created since startup and the bytes they took up. */
+static struct {
+    size_t objects;
+    size_t bytes;
+} _total = { 0, 0 };
+
+static li_bool_t _black = LI_FALSE;
+
+/* The open region, see li_heap_region_begin. */
+static struct {
+    li_bool_t open;
+    li_bool_t marking;      /* whether only region objects are being marked */
+    size_t allocated;       /* _allocated when the region was opened */
+    li_page_t *cursor[LI_NUM_CLASSES];
+    li_page_t **pages;
+    size_t size;
+    size_t cap;
+} _region = { LI_FALSE, LI_FALSE, 0, { NULL }, NULL, 0, 0 };
+
+static size_t li_slot_size(size_t size)
+{
+    if (size < LI_SLOT_MIN)
+        size = LI_SLOT_MIN;
+    return (size + LI_SLOT_ALIGN - 1) & ~(size_t)(LI_SLOT_ALIGN - 1);
+}
+
+/*
+ * The page table.
+ */
+
+static size_t li_pages_hash(li_page_t *page)
+{
+    size_t h = (size_t)page / LI_PAGE_SIZE;
+    return (h * 2654435761u) & (_pages.cap - 1);
+}
+
+static void li_pages_insert(li_page_t *page)
+{
+    size_t i;
+    if (2 * (_pages.size + 1) > _pages.cap) {
+        li_page_t **table = _pages.table;
+        size_t cap = _pages.cap;
+        _pages.cap = cap ? 2 * cap : 64;
+        _pages.table = li_allocate(NULL, _pages.cap, sizeof(*_pages.table));
+        _pages.size = 0;
+        for (i = 0; i < cap; i++)
+            if (table[i])
+                li_pages_insert(table[i]);
+        free(table);
+    }
+    for (i = li_pages_hash(page); _pages.table[i];
+            i = (i + 1) & (_pages.cap - 1))
+        ;
+    _pages.table[i] = page;
+    _pages.size++;
+}
+
+static void li_pages_remove(li_page_t *page)
+{
+    size_t i, j, k;
+    for (i = li_pages_hash(page); _pages.table[i] != page;
+            i = (i + 1) & (_pages.cap - 1))
+        ;
+    /* Shift back entries which would become unreachable. */
+    for (j = i; ; ) {
+        _pages.table[i] = NULL;
+        do {
+            j = (j + 1) & (_pages.cap - 1);
+            if (!_pages.table[j]) {
+                _pages.size--;
+                return;
+            }
+            k = li_pages_hash(_pages.table[j]);
+        } while (i <= j ? i < k && k <= j : i < k || k <= j);
+        _pages.table[i] = _pages.table[j];
+        i = j;
+    }
+}
+
+static li_bool_t li_heap_contains(li_object *obj)
+{
+    li_page_t *page = li_page_of(obj);
+    size_t i;
+    if (!_pages.cap || li_is_immediate(obj))
+        return LI_FALSE;
+    for (i = li_pages_hash(page); _pages.table[i];
+            i = (i + 1) & (_pages.cap - 1))
+        if (_pages.table[i] == page)
+            return LI_TRUE;
+    return LI_FALSE;
+}
+
+/*
+ * Allocation.
+ */
+
+static li_page_t *li_page_new(size_t size, size_t bytes)
+{
+    li_page_t *page;
+    void *mem = NULL;
+    if (posix_memalign(&mem, LI_PAGE_SIZE, bytes))
+        li_error_fmt("out of memory");
+    page = mem;
+    memset(page, 0, LI_PAGE_HEAD);
+    page->size = size;
+    page->bump = li_page_slots(page);
+    page->end = page->bump + (bytes - LI_PAGE_HEAD) / size * size;
+    li_pages_insert(page);
+    _pages.bytes += bytes;
+    return page;
+}
+
+static void li_page_push(li_page_t *page, li_page_t **pages)
+{
+    page->next = *pages;
+    if (page->next)
+        page->next->prev = page;
+    *pages = page;
+}
+
+static void li_page_free(li_page_t *page, li_page_t **pages)
+{
+    if (page->prev)
+        page->prev->next = page->next;
+    else
+        *pages = page->next;
+    if (page->next)
+        page->next->prev = page->prev;
+    li_pages_remove(page);
+    _pages.bytes -= li_page_bytes(page);
+    free(page);
+}
+
+static li_object *li_page_alloc(li_page_t *page)
+{
+    li_object *obj;
+    if (page->free) {
+        obj = (li_object *)page->free;
+        page->free = page->free->next;
+    } else if (page->bump < page->end) {
+        obj = (li_object *)page->bump;
+        page->bump += page->size;
+    } else {
+        return NULL;
+    }
+    if (!page->young) {
+        page->young = LI_TRUE;
+        page->young_next = _nursery;
+        _nursery = page;
+    }
+    return obj;
+}
+
+static void li_region_add(li_page_t *page)
+{
+    if (_region.size == _region.cap) {
+        _region.cap = _region.cap ? LI_INC_CAP(_region.cap) : 64;
+        _region.pages = li_reallocate(_region.pages, _region.size,
+                _region.cap, sizeof(*_region.pages));
+    }
+    _region.pages[_region.size++] = page;
+    page->region = LI_TRUE;
+}
+
+static li_object *li_alloc_small(size_t size)
+{
+    li_page_t *page;
+    li_object *obj;
+    int i = size / LI_SLOT_ALIGN - 1;
+    if (_region.open) {
+        page = _region.cursor[i];
+        if (page && (obj = li_page_alloc(page)))
+            return obj;
+        page = li_page_new(size, LI_PAGE_SIZE);
+        li_page_push(page, &_classes[i].pages);
+        li_region_add(page);
+        _region.cursor[i] = page;
+        return li_page_alloc(page);
+    }
+    for (page = _classes[i].cursor; page; page = page->next) {
+        if ((obj = li_page_alloc(page))) {
+            _classes[i].cursor = page;
+            return obj;
+        }
+    }
+    page = li_page_new(size, LI_PAGE_SIZE);
+    li_page_push(page, &_classes[i].pages);
+    _classes[i].cursor = page;
+    return li_page_alloc(page);
+}
+
+static li_object *li_alloc_large(size_t size)
+{
+    li_page_t *page = li_page_new(size, LI_PAGE_HEAD + size);
+    li_page_push(page, &_large);
+    if (_region.open)
+        li_region_add(page);
+    return li_page_alloc(page);
+}
+
+extern void *li_allocate(void *ptr, size_t count, size_t size)
+{
+    if (ptr)
+        ptr = realloc(ptr, count*size);
+    else
+        ptr = calloc(count, size);
+    if (!ptr)
+        li_error_fmt("out of memory");
+    _allocated += count*size;
+    return ptr;
+}
+
+extern void *li_reallocate(void *ptr, size_t old, size_t count, size_t size)
+{
+    if (!ptr)
+        return li_allocate(NULL, count, size);
+    if (!(ptr = realloc(ptr, count*size)))
+        li_error_fmt("out of memory");
+    if (count > old)
+        _allocated += (count - old)*size;
+    return ptr;
+}
+
+extern void li_object_init(li_object *obj, const li_type_t *type)
+{
+    obj->type = type;
+}
+
+extern li_object *li_create(const li_type_t *type)
+{
+    if (!type->size)
+        li_error_fmt("programmer error: type ~s has no size data",
+                li_string_make(type->name));
+    return li_create_sized(type, type->size);
+}
+
+extern li_object *li_create_sized(const li_type_t *type, size_t size)
+{
+    li_object *obj;
+    size_t slot = li_slot_size(size);
+    obj = slot > LI_SLOT_MAX ? li_alloc_large(slot) : li_alloc_small(slot);
+    memset(obj, 0, size);
+    li_object_init(obj, type);
+    if (_black) {
+        li_page_t *page = li_page_of(obj);
+        li_bit_set(page->marked, li_page_bit(page, obj));
+    }
+    _allocated += slot;
+    _total.objects++;
+    _total.bytes += slot;
+    return obj;
+}
+
+extern void li_destroy(li_object *obj)
+{
+    li_page_t *page;
+    size_t i;
+    if (!obj || !obj->type)
+        return;
+    if (li_type(obj)->deinit)
+        li_type(obj)->deinit(obj);
+    obj->type = NULL;
+    page = li_page_of(obj);
+    i = li_page_bit(page, obj);
+    li_bit_clear(page->old, i);
+    li_bit_clear(page->remembered, i);
+}
+
+extern size_t li_heap_allocated(void)
+{
+    return _allocated;
+}
+
+extern void li_heap_allocate_black(li_bool_t black)
+{
+    _black = black;
+}
+
+/*
+ * Marking and generations.
+ */
+
+extern li_bool_t li_heap_mark(li_object *obj, li_bool_t minor)
+{
+    li_page_t *page = li_page_of(obj);
+    size_t i = li_page_bit(page, obj);
+    li_byte_t *byte = &page->marked[i / 8], bit = 1 << (i % 8);
+    if (!li_heap_contains(obj) || (minor && li_bit_get(page->old, i))
+            || (_region.marking && !page->region))
+        return LI_FALSE;
+    /* Several threads may be marking objects on the same page. */
+    if (__atomic_load_n(byte, __ATOMIC_RELAXED) & bit)
+        return LI_FALSE;
+    return !(__atomic_fetch_or(byte, bit, __ATOMIC_RELAXED) & bit);
+}
+
+extern li_bool_t li_heap_live(li_object *obj, li_bool_t minor)
+{
+    li_page_t *page = li_page_of(obj);
+    size_t i = li_page_bit(page, obj);
+    if (!obj || !li_heap_contains(obj) || (_region.marking && !page->region))
+        return LI_TRUE;
+    return li_bit_get(page->marked, i) || (minor && li_bit_get(page->old, i));
+}
+
+extern void li_heap_remember(li_object *obj)
+{
+    li_page_t *page = li_page_of(obj);
+    size_t i = li_page_bit(page, obj);
+    if (li_bit_get(page->remembered, i) || (_region.open
+                ? page->region : !li_bit_get(page->old, i)))
+        return;
+    li_bit_set(page->remembered, i);
+    if (_remembered.size == _remembered.cap) {
+        _remembered.cap = _remembered.cap ? LI_INC_CAP(_remembered.cap) : 64;
+        _remembered.objs = li_reallocate(_remembered.objs, _remembered.size,
+                _remembered.cap, sizeof(*_remembered.objs));
+    }
+    _remembered.objs[_remembered.size++] = obj;
+}
+
+extern void li_heap_mark_remembered(void)
+{
+    size_t i;
+    for (i = 0; i < _remembered.size; i++) {
+        li_object *obj = _remembered.objs[i];
+        if (li_type(obj)->mark)
+            li_type(obj)->mark(obj);
+    }
+}
+
+static void li_heap_forget_remembered(void)
+{
+    while (_remembered.size) {
+        li_object *obj = _remembered.objs[--_remembered.size];
+        li_page_t *page = li_page_of(obj);
+        li_bit_clear(page->remembered, li_page_bit(page, obj));
+    }
+}
+
+/* Forgets the young objects a region remembered. */
+static void li_heap_forget_young(void)
+{
+    size_t i, n;
+    for (i = n = 0; i < _remembered.size; i++) {
+        li_object *obj = _remembered.objs[i];
+        li_page_t *page = li_page_of(obj);
+        size_t j = li_page_bit(page, obj);
+        if (li_bit_get(page->old, j))
+            _remembered.objs[n++] = obj;
+        else
+            li_bit_clear(page->remembered, j);
+    }
+    _remembered.size = n;
+}
+
+/*
+ * Sweeping.
+ */
+
+static void li_page_release(li_page_t *page)
+{
+    if (page->size > LI_SLOT_MAX)
+        li_page_free(page, &_large);
+    else
+        li_page_free(page, &_classes[page->size / LI_SLOT_ALIGN - 1].pages);
+}
+
+/*
+ * Sweeps a single page, promotes its survivors and rebuilds its free list.
+ * A minor sweep leaves old objects alone.  If defer is true, dead objects
+ * which need to be deinitialized are left for li_page_sweep_pending, since
+ * deinit functions may not be safe to call from several threads.  Sets the
+ * number of objects left on the page and adds the size of the promoted ones
+ * to promoted.
+ */
+static void li_page_sweep(li_page_t *page, li_bool_t minor, li_bool_t defer,
+        size_t *promoted)
+{
+    char *slot;
+    page->free = NULL;
+    page->live = 0;
+    for (slot = li_page_slots(page); slot < page->bump; slot += page->size) {
+        li_free_t *free_slot = (li_free_t *)slot;
+        li_object *obj = (li_object *)slot;
+        size_t i = li_page_bit(page, obj);
+        if (obj->type && minor && li_bit_get(page->old, i)) {
+            page->live++;
+            continue;
+        } else if (obj->type && li_bit_get(page->marked, i)) {
+            if (!li_bit_get(page->old, i)) {
+                li_bit_set(page->old, i);
+                *promoted += page->size;
+            }
+            page->live++;
+            continue;
+        } else if (obj->type && defer && li_type(obj)->deinit) {
+            page->pending = LI_TRUE;
+            continue;
+        }
+        li_destroy(obj);
+        free_slot->next = page->free;
+        page->free = free_slot;
+    }
+    if (!page->pending)
+        memset(page->marked, 0, sizeof(page->marked));
+    page->young = LI_FALSE;
+}
+
+/* Destroys the dead objects a deferring sweep left on the page. */
+static void li_page_sweep_pending(li_page_t *page)
+{
+    char *slot;
+    for (slot = li_page_slots(page); slot < page->bump; slot += page->size) {
+        li_free_t *free_slot = (li_free_t *)slot;
+        li_object *obj = (li_object *)slot;
+        if (obj->type && !li_bit_get(page->marked, li_page_bit(page, obj))) {
+            li_destroy(obj);
+            free_slot->next = page->free;
+            page->free = free_slot;
+        }
+    }
+    memset(page->marked, 0, sizeof(page->marked));
+    page->pending = LI_FALSE;
+}
+
+static void li_heap_swept(void)
+{
+    int i;
+    for (i = 0; i < LI_NUM_CLASSES; i++)
+        _classes[i].cursor = _classes[i].pages;
+    _nursery = NULL;
+    _allocated = 0;
+}
+
+extern size_t li_heap_sweep_begin(void)
+{
+    li_page_t *page;
+    int i;
+    li_heap_forget_remembered();
+    _sweep.size = 0;
+    for (i = 0; i <= LI_NUM_CLASSES; i++) {
+        page = i < LI_NUM_CLASSES ? _classes[i].pages : _large;
+        for (; page; page = page->next) {
+            if (_sweep.size == _sweep.cap) {
+                _sweep.cap = _sweep.cap ? LI_INC_CAP(_sweep.cap) : 64;
+                _sweep.pages = li_reallocate(_sweep.pages, _sweep.size,
+                        _sweep.cap, sizeof(*_sweep.pages));
+            }
+            _sweep.pages[_sweep.size++] = page;
+        }
+    }
+    return _sweep.size;
+}
+
+extern void li_heap_sweep_page(size_t i, size_t *promoted)
+{
+    li_page_sweep(_sweep.pages[i], LI_FALSE, LI_TRUE, promoted);
+}
+
+extern size_t li_heap_sweep_end(void)
+{
+    size_t bytes = 0, i;
+    for (i = 0; i < _sweep.size; i++) {
+        li_page_t *page = _sweep.pages[i];
+        if (page->pending)
+            li_page_sweep_pending(page);
+        if (page->live)
+            bytes += page->live * page->size;
+        else
+            li_page_release(page);
+    }
+    _sweep.size = 0;
+    li_heap_swept();
+    return bytes;
+}
+
+extern size_t li_heap_sweep(li_bool_t minor, size_t *promoted)
+{
+    li_page_t *page, *next;
+    size_t i, n;
+    *promoted = 0;
+    if (!minor) {
+        n = li_heap_sweep_begin();
+        for (i = 0; i < n; i++)
+            li_page_sweep(_sweep.pages[i], LI_FALSE, LI_FALSE, promoted);
+        return li_heap_sweep_end();
+    }
+    li_heap_forget_remembered();
+    for (page = _nursery; page; page = next) {
+        next = page->young_next;
+        li_page_sweep(page, LI_TRUE, LI_FALSE, promoted);
+        if (!page->live)
+            li_page_release(page);
+    }
+    li_heap_swept();
+    return 0;
+}
+
+/*
+ * Regions.
+ */
+
+extern void li_heap_region_begin(void)
+{
+    _region.open = LI_TRUE;
+    _region.allocated = _allocated;
+}
+
+extern li_bool_t li_heap_region_open(void)
+{
+    return _region.open;
+}
+
+extern size_t li_heap_region_allocated(void)
+{
+    return _allocated - _region.allocated;
+}
+
+extern void li_heap_region_mark(void)
+{
+    _region.marking = LI_TRUE;
+}
+
+extern void li_heap_region_dissolve(void)
+{
+    size_t i;
+    for (i = 0; i < _region.size; i++)
+        _region.pages[i]->region = LI_FALSE;
+    for (i = 0; i < LI_NUM_CLASSES; i++)
+        _region.cursor[i] = NULL;
+    _region.size = 0;
+    _region.open = _region.marking = LI_FALSE;
+    li_heap_forget_young();
+}
+
+extern size_t li_heap_region_end(void)
+{
+    li_page_t **link;
+    size_t live = 0, i, n;
+    for (i = 0; i < _region.size; i++) {
+        li_page_t *page = _region.pages[i];
+        char *slot;
+        page->free = NULL;
+        page->live = 0;
+        for (slot = li_page_slots(page); slot < page->bump; slot += page->size) {
+            li_free_t *free_slot = (li_free_t *)slot;
+            li_object *obj = (li_object *)slot;
+            if (li_bit_get(page->marked, li_page_bit(page, obj))) {
+                page->live++;
+                continue;
+            }
+            li_destroy(obj);
+            free_slot->next = page->free;
+            page->free = free_slot;
+        }
+        memset(page->marked, 0, sizeof(page->marked));
+        live += page->live * page->size;
+    }
+    for (link = &_nursery; *link; ) {
+        if ((*link)->region && !(*link)->live)
+            *link = (*link)->young_next;
+        else
+            link = &(*link)->young_next;
+    }
+    for (i = n = 0; i < _region.size; i++) {
+        if (_region.pages[i]->live)
+            _region.pages[n++] = _region.pages[i];
+        else
+            li_page_release(_region.pages[i]);
+    }
+    _region.size = n;
+    li_heap_region_dissolve();
+    _allocated = _region.allocated + live;
+    return live;
+}
+
+/*
+ * While the heap is counted, stats->types is indexed by a hash table of type
+ * pointers like the page table above, holding one plus the entry of each type.
+ */
+typedef struct {
+    li_gc_stats_t *stats;
+    size_t cap;
+    size_t *table;
+    size_t table_cap;
+} li_type_counts_t;
+
+static size_t li_type_hash(const li_type_t *type, size_t cap)
+{
+    size_t h = (size_t)type / sizeof(void *);
+    return (h * 2654435761u) & (cap - 1);
+}
+
+static li_gc_type_stats_t *li_type_counts_get(li_type_counts_t *counts,
+        const li_type_t *type)
+{
+    li_gc_stats_t *stats = counts->stats;
+    size_t i, j;
+    if (2 * (stats->num_types + 1) > counts->table_cap) {
+        free(counts->table);
+        counts->table_cap = counts->table_cap ? 2 * counts->table_cap : 64;
+        counts->table = li_allocate(NULL, counts->table_cap,
+                sizeof(*counts->table));
+        for (j = 0; j < stats->num_types; j++) {
+            for (i = li_type_hash(stats->types[j].type, counts->table_cap);
+                    counts->table[i]; i = (i + 1) & (counts->table_cap - 1))
+                ;
+            counts->table[i] = j + 1;
+        }
+    }
+    for (i = li_type_hash(type, counts->table_cap); counts->table[i];
+            i = (i + 1) & (counts->table_cap - 1))
+        if (stats->types[counts->table[i] - 1].type == type)
+            return &stats->types[counts->table[i] - 1];
+    j = stats->num_types++;
+    if (j == counts->cap) {
+        counts->cap = counts->cap ? LI_INC_CAP(counts->cap) : 32;
+        stats->types = li_reallocate(stats->types, j, counts->cap,
+                sizeof(*stats->types));
+    }
+    counts->table[i] = j + 1;
+    stats->types[j].type = type;
+    stats->types[j].count = 0;
+    stats->types[j].bytes = 0;
+    return &stats->types[j];
+}
+
+static void li_pages_count(li_page_t *page, li_type_counts_t *counts)
+{
+    char *slot;
+    for (; page; page = page->next) {
+        for (slot = li_page_slots(page); slot < page->bump; slot += page->size) {
+            li_object *obj = (li_object *)slot;
+            li_gc_type_stats_t *entry;
+            if (!obj->type)
+                continue;
+            entry = li_type_counts_get(counts, obj->type);
+            entry->count++;
+            entry->bytes += page->size;
+        }
+    }
+}
+
+extern void li_heap_stats(li_gc_stats_t *stats)
+{
+    li_type_counts_t counts = { NULL, 0, NULL, 0 };
+    int i;
+    counts.stats = stats;
+    stats->allocations = _total.objects;
+    stats->allocated_bytes = _total.bytes;
+    stats->heap_bytes = _pages.bytes;
+    stats->types = NULL;
+    stats->num_types = 0;
+    for (i = 0; i < LI_NUM_CLASSES; i++)
+        li_pages_count(_classes[i].pages, &counts);
+    li_pages_count(_large, &counts);
+    free(counts.table);
+}
+
+static void li_pages_each(li_page_t *page,
+        void (*fn)(li_object *, size_t, void *), void *data)
+{
+    char *slot;
+    for (; page; page = page->next)
+        for (slot = li_page_slots(page); slot < page->bump; slot += page->size)
+            if (((li_object *)slot)->type)
+                fn((li_object *)slot, page->size, data);
+}
+
+extern void li_heap_each(void (*fn)(li_object *, size_t, void *), void *data)
+{
+    int i;
+    for (i = 0; i < LI_NUM_CLASSES; i++)
+        li_pages_each(_classes[i].pages, fn, data);
+    li_pages_each(_large, fn, data);
+}
+
+static void li_pages_destroy(li_page_t *page, li_bool_t dl)
+{
+    char *slot;
+    for (; page; page = page->next) {
+        for (slot = li_page_slots(page); slot < page->bump; slot += page->size) {
+            li_object *obj = (li_object *)slot;
+            if (obj->type && (obj->type == &li_type_dl) == dl)
+                li_destroy(obj);
+        }
+    }
+}
+
+static void li_pages_free(li_page_t *page)
+{
+    li_page_t *next;
+    for (; page; page = next) {
+        next = page->next;
+        free(page);
+    }
+}
+
+extern void li_heap_free(void)
+{
+    int i;
+    for (i = 0; i < LI_NUM_CLASSES; i++)
+        li_pages_destroy(_classes[i].pages, LI_FALSE);
+    li_pages_destroy(_large, LI_FALSE);
+    for (i = 0; i < LI_NUM_CLASSES; i++)
+        li_pages_destroy(_classes[i].pages, LI_TRUE);
+    li_pages_destroy(_large, LI_TRUE);
+    for (i = 0; i < LI_NUM_CLASSES; i++) {
+        li_pages_free(_classes[i].pages);
+        _classes[i].pages = _classes[i].cursor = NULL;
+    }
+    li_pages_free(_large);
+    _large = NULL;
+    _nursery = NULL;
+    free(_pages.table);
+    _pages.table = NULL;
+    _pages.cap = _pages.size = _pages.bytes = 0;
+    free(_remembered.objs);
+    _remembered.objs = NULL;
+    _remembered.cap = _remembered.size = 0;
+    free(_sweep.pages);
+    _sweep.pages = NULL;
+    _sweep.cap = _sweep.size = 0;
+    free(_region.pages);
+    _region.pages = NULL;
+    _region.cap = 0;
+    li_heap_region_dissolve();
+    _allocated = 0;
+}
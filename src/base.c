@@ -12,6 +12,7 @@
  *     e = li_env_t
  *     I = li_int_t
  *     i = int
+ *     k = int, not negative
  *     l = li_object (list)
  *     n = li_num_t
  *     o = li_object
@@ -68,17 +69,23 @@ extern void li_parse_args(li_object *args, const char *fmt, ...)
             break;
         case 'I':
             li_assert_integer(obj);
+            if (!li_num_fits_long((li_num_t *)obj))
+                li_error_fmt("integer out of range: ~a", obj);
             *va_arg(ap, li_int_t *) = li_to_integer(obj);
             break;
         case 'i':
             li_assert_integer(obj);
-            *va_arg(ap, int *) = (int)li_to_integer(obj);
+            if (li_to_integer(obj) < INT_MIN || li_to_integer(obj) > INT_MAX)
+                li_error_fmt("integer out of range: ~a", obj);
+            *va_arg(ap, int *) = li_to_integer(obj);
             break;
         case 'k':
             li_assert_integer(obj);
             if (li_to_integer(obj) < 0)
                 li_error_fmt("expected a positive integer: ~a", obj);
-            *va_arg(ap, int *) = (int)li_to_integer(obj);
+            if (li_to_integer(obj) > INT_MAX)
+                li_error_fmt("integer out of range: ~a", obj);
+            *va_arg(ap, int *) = li_to_integer(obj);
             break;
         case 'l':
             li_assert_list(obj);
@@ -188,7 +195,7 @@ static li_object *m_case(li_object *expr, li_env_t *env)
         li_object *clause, *atoms, *atom;
         li_parse_args(clauses, "o.", &clause, &clauses);
         li_parse_args(clause, "o.", &atoms, &results);
-        if (li_is_eq(atoms, li_symbol("else")))
+        if (li_is_eq(atoms, li_sym_else))
             break;
         li_assert_list(atoms);
         while (atoms) {
@@ -203,7 +210,7 @@ exit:
     if (!results)
         return li_false;
     /* TODO: test this. */
-    if (li_is_eq(li_car(results), li_symbol("=>"))) {
+    if (li_is_eq(li_car(results), li_sym_arrow)) {
         li_object *_, *proc;
         li_parse_args(results, "oo", &_, &proc);
         return li_cons(proc, li_cons(key, NULL));
@@ -223,7 +230,7 @@ static li_object *m_case_lambda(li_object *expr, li_env_t *env)
     li_object *lambda = li_cons(li_string_make("wrong number of args"), args);
     lambda = li_cons(li_symbol("error"), lambda);
     lambda = li_cons(lambda, NULL);
-    lambda = li_cons(li_symbol("else"), lambda);
+    lambda = li_cons(li_sym_else, lambda);
     lambda = li_cons(lambda, NULL);
     while (clauses) {
         li_object *clause, *formals, *body;
@@ -251,14 +258,14 @@ static li_object *m_cond(li_object *expr, li_env_t *env)
     li_object *cond, *results = NULL;
     while (clauses) {
         li_parse_args(li_car(clauses), "o.", &cond, &results);
-        if (li_is_eq(cond, li_symbol("else")) || !li_not(li_eval(cond, env)))
+        if (li_is_eq(cond, li_sym_else) || !li_not(li_eval(cond, env)))
             break;
         results = NULL;
         clauses = li_cdr(clauses);
     }
     if (!results)
         return li_false;
-    if (li_is_eq(li_car(results), li_symbol("=>"))) {
+    if (li_is_eq(li_car(results), li_sym_arrow)) {
         li_object *_, *proc;
         li_parse_args(results, "oo", &_, &proc);
         return li_cons(proc, li_cons(cond, NULL));
@@ -284,7 +291,7 @@ static li_object *m_define(li_object *expr, li_env_t *env)
             if (li_is_symbol(li_car(var)))
                 val = li_lambda((li_sym_t *)li_car(var), li_cdr(var), val, env);
             else
-                val = li_cons(li_cons(li_symbol("lambda"),
+                val = li_cons(li_cons(li_sym_lambda,
                             li_cons(li_cdr(var), val)), NULL);
             var = li_car(var);
         }
@@ -343,9 +350,9 @@ static li_object *m_do(li_object *expr, li_env_t *env)
     tail = li_set_car(tail, li_cons(li_symbol("cond"), NULL));
     tail = li_set_cdr(tail, li_cons(li_cadr(seq), NULL));
     tail = li_set_cdr(tail, li_cons(NULL, NULL));
-    tail = li_set_car(tail, li_cons(li_symbol("else"), NULL));
+    tail = li_set_car(tail, li_cons(li_sym_else, NULL));
     for (iter = li_cddr(seq); iter; iter = li_cdr(iter))
-        tail = li_set_cdr(tail, iter);
+        tail = li_set_cdr(tail, li_cons(li_car(iter), NULL));
     tail = li_set_cdr(tail,
             li_cons(li_cons(li_symbol("#"), let_args), NULL));
     return head;
@@ -483,7 +490,7 @@ static li_object *m_or(li_object *expr, li_env_t *env)
     li_object *val;
     for (; seq && li_cdr(seq); seq = li_cdr(seq))
         if (!li_not(val = li_eval(li_car(seq), env)))
-            return li_cons(li_symbol("quote"), li_cons(val, NULL));
+            return li_cons(li_sym_quote, li_cons(val, NULL));
     if (!seq)
         return li_false;
     return li_car(seq);
@@ -568,6 +575,13 @@ static li_object *_cmp_helper(li_object *args, li_cmp_t a)
         if (!li_cdr(args))
             return li_true;
         obj2 = li_cadr(args);
+        if (li_is_fixnum(obj1) && li_is_fixnum(obj2)) {
+            long x = li_fixnum_value(obj1), y = li_fixnum_value(obj2);
+            if ((x < y ? LI_CMP_LT : x > y ? LI_CMP_GT : LI_CMP_EQ) != a)
+                return li_false;
+            args = li_cdr(args);
+            continue;
+        }
         if (li_type(obj1) != li_type(obj2))
             return li_false;
         if (li_type(obj1)->compare(obj1, obj2) != a)
@@ -649,6 +663,8 @@ static li_object *p_isa(li_object *args)
 
 extern void li_setup_environment(li_env_t *env)
 {
+    li_gc_protect((li_object *)env);
+    li_intern_well_known_symbols();
     lilib_defmac(env, "and",            m_and);
     lilib_defmac(env, "assert",         m_assert);
     lilib_defmac(env, "begin",          m_begin);
@@ -707,12 +723,16 @@ extern void li_setup_environment(li_env_t *env)
     li_define_boolean_functions(env);
     li_define_bytevector_functions(env);
     li_define_char_functions(env);
+    li_define_dump_functions(env);
+    li_define_gc_functions(env);
     li_define_number_functions(env);
     li_define_pair_functions(env);
     li_define_port_functions(env);
     li_define_string_functions(env);
     li_define_symbol_functions(env);
     li_define_vector_functions(env);
+    li_define_weak_functions(env);
+    li_define_hash_functions(env);
     li_define_procedure_functions(env);
     li_init_syntax(env);
 }
@@ -1,33 +1,14 @@
 #include "li.h"
 #include "li_lib.h"
 
-struct li_boolean_t {
-    LI_OBJ_HEAD;
-    const char *name;
-};
-
-static li_boolean_t booleans[2] = {
-    { .type = &li_type_boolean, .name = "#f", },
-    { .type = &li_type_boolean, .name = "#t", },
-};
-
-li_object *li_false = (li_object *)&booleans[0];
-li_object *li_true = (li_object *)&booleans[1];
-
-void boolean_deinit(li_object *obj)
-{
-    (void)obj;
-}
-
-void boolean_write(li_boolean_t *bol, li_port_t *port)
+void boolean_write(li_object *obj, li_port_t *port)
 {
-    li_port_printf(port, "%s", bol->name);
+    li_port_printf(port, "%s", obj == li_true ? "#t" : "#f");
 }
 
 const li_type_t li_type_boolean = {
     .name = "boolean",
-    .deinit = boolean_deinit,
-    .write = (li_write_f *)boolean_write,
+    .write = boolean_write,
 };
 
 /*
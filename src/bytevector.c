@@ -1,17 +1,43 @@
 #include "li.h"
+#include "li_gc.h"
 
+#include <assert.h>
 #include <string.h> /* memset */
 
+/* Bytevectors shorter than this keep their bytes inline, like strings. */
+#define LI_BYTEVECTOR_INLINE_SIZE 24
+
+/* Where the bytes of a bytevector kept inline start. */
+#define bytevector_inline(v) ((li_byte_t *)((v) + 1))
+
+/*
+ * A copy of part of a bytevector may share its bytes, the same way vectors do
+ * (see vector.c).
+ */
 struct li_bytevector_t {
     LI_OBJ_HEAD;
     int length;
     li_byte_t *bytes;
+    li_bytevector_t *parent;
+    li_bool_t shared;
 };
 
 static void bytevector_deinit(li_bytevector_t *v)
 {
-    free(v->bytes);
-    free(v);
+    if (!v->parent && v->bytes != bytevector_inline(v))
+        free(v->bytes);
+}
+
+/* The copy is followed by a zero, like the bytes of li_make_bytevector. */
+static void bytevector_unshare(li_bytevector_t *v)
+{
+    li_byte_t *bytes;
+    if (!v->parent)
+        return;
+    bytes = li_allocate(NULL, v->length + 1, sizeof(*bytes));
+    memcpy(bytes, v->bytes, v->length);
+    v->bytes = bytes;
+    v->parent = NULL;
 }
 
 static void bytevector_write(li_bytevector_t *v, li_port_t *port)
@@ -47,13 +73,31 @@ const li_type_t li_type_bytevector = {
     .set = (li_set_f *)bytevector_set,
 };
 
-extern li_bytevector_t *li_make_bytevector(int k, li_byte_t byte)
+/* Makes a bytevector with room for k bytes, followed by a zero. */
+static li_bytevector_t *bytevector_alloc(size_t k)
 {
-    li_bytevector_t *v = (li_bytevector_t *)li_create(&li_type_bytevector);
-    v->bytes = li_allocate(NULL, k + 1, sizeof(*v->bytes));
-    v->length = k;
-    memset(v->bytes, byte, k * sizeof(*v->bytes));
+    li_bytevector_t *v;
+    if (k < LI_BYTEVECTOR_INLINE_SIZE) {
+        v = (li_bytevector_t *)li_create_sized(&li_type_bytevector,
+                sizeof(li_bytevector_t) + k + 1);
+        v->bytes = bytevector_inline(v);
+    } else {
+        v = (li_bytevector_t *)li_create(&li_type_bytevector);
+        v->bytes = li_allocate(NULL, k + 1, sizeof(*v->bytes));
+    }
     v->bytes[k] = 0;
+    v->length = k;
+    v->parent = NULL;
+    v->shared = LI_FALSE;
+    return v;
+}
+
+extern li_bytevector_t *li_make_bytevector(int k, li_byte_t byte)
+{
+    li_bytevector_t *v;
+    assert(k >= 0);
+    v = bytevector_alloc(k);
+    memset(v->bytes, byte, (size_t)k * sizeof(*v->bytes));
     return v;
 }
 
@@ -62,21 +106,21 @@ extern li_bytevector_t *li_bytevector_with_chars(const char *s)
     li_bytevector_t *v = (li_bytevector_t *)li_create(&li_type_bytevector);
     v->length = strlen(s);
     v->bytes = (li_byte_t *)s;
+    v->parent = NULL;
+    v->shared = LI_FALSE;
     return v;
 }
 
 extern const char *li_bytevector_chars(li_bytevector_t *v)
 {
+    bytevector_unshare(v);
     return (const char *)v->bytes;
 }
 
 extern li_bytevector_t *li_bytevector(li_object *lst)
 {
     int i;
-    li_bytevector_t *v = li_allocate(NULL, 1, sizeof(*v));
-    li_object_init((li_object *)v, &li_type_bytevector);
-    v->length = li_length(lst);
-    v->bytes = li_allocate(NULL, v->length, sizeof(*v->bytes));
+    li_bytevector_t *v = bytevector_alloc(li_length(lst));
     for (i = 0; i < v->length; ++i)
         li_parse_args(lst, "b.", &v->bytes[i], &lst);
     return v;
@@ -94,6 +138,12 @@ extern li_byte_t li_bytevector_get(li_bytevector_t *v, int k)
 
 extern void li_bytevector_set(li_bytevector_t *v, int k, li_byte_t byte)
 {
+    if (v->parent) {
+        bytevector_unshare(v);
+    } else if (v->shared) {
+        li_gc_unshare_slices((li_object *)v);
+        v->shared = LI_FALSE;
+    }
     v->bytes[k] = byte;
 }
 
@@ -101,7 +151,7 @@ static li_object *p_is_bytevector(li_object *args)
 {
     li_object *obj;
     li_parse_args(args, "o", &obj);
-    return li_boolean(li_is_type(obj, &li_type_bytevector));
+    return li_boolean(li_is_bytevector(obj));
 }
 
 static li_object *p_make_bytevector(li_object *args)
@@ -164,12 +214,35 @@ static li_bytevector_t *bytevector_copy(
 }
 
 
+/* Copies the bytes of v from start to end, sharing them if there are enough
+ * of them. */
+static li_bytevector_t *bytevector_slice(li_bytevector_t *v, int start,
+        int end)
+{
+    li_bytevector_t *slice;
+    if (end < 0)
+        end = li_bytevector_length(v);
+    if (start > end || end > li_bytevector_length(v))
+        li_error_fmt("start and end are out of range");
+    if (end - start < LI_SLICE_MIN_SIZE)
+        return bytevector_copy(NULL, 0, v, start, end);
+    slice = (li_bytevector_t *)li_create(&li_type_bytevector);
+    slice->bytes = v->bytes + start;
+    slice->length = end - start;
+    slice->parent = v->parent ? v->parent : v;
+    slice->shared = LI_FALSE;
+    slice->parent->shared = LI_TRUE;
+    li_gc_add_slice((li_object *)slice, (li_object *)slice->parent,
+            (li_unshare_f *)bytevector_unshare);
+    return slice;
+}
+
 static li_object *p_bytevector_copy(li_object *args)
 {
     li_bytevector_t *from;
     int start = 0, end = -1;
     li_parse_args(args, "B?kk", &from, &start, &end);
-    return (li_object *)bytevector_copy(NULL, 0, from, start, end);
+    return (li_object *)bytevector_slice(from, start, end);
 }
 
 static li_object *p_bytevector_copy_ex(li_object *args)
@@ -207,7 +280,7 @@ static li_object *p_bytevector_to_string(li_object *args)
     li_parse_args(args, "B?kk", &v, &start, &end);
     if (end >= 0)
         li_error_fmt("end arg not supported");
-    return (li_object *)li_string_make((char *)v->bytes + start);
+    return (li_object *)li_string_make(li_bytevector_chars(v) + start);
 }
 
 static li_object *p_string_to_bytevector(li_object *args)
@@ -1,14 +1,14 @@
 #include "li.h"
 #include "li_lib.h"
 
-static void display(li_character_obj_t *obj, li_port_t *port)
+static void display(li_object *obj, li_port_t *port)
 {
     char buf[5] = {'\0'};
     li_chr_encode(li_to_character(obj), buf, 4);
     li_port_printf(port, "%s", buf);
 }
 
-static void write(li_character_obj_t *obj, li_port_t *port)
+static void write(li_object *obj, li_port_t *port)
 {
     char buf[5] = {'\0'};
     li_chr_encode(li_to_character(obj), buf, 4);
@@ -29,19 +29,11 @@ static li_cmp_t compare(li_object *obj1, li_object *obj2)
 
 const li_type_t li_type_character = {
     .name = "character",
-    .size = sizeof(li_character_obj_t *),
-    .write = (li_write_f *)write,
-    .display = (li_write_f *)display,
+    .write = write,
+    .display = display,
     .compare = compare,
 };
 
-extern li_object *li_character(li_character_t c)
-{
-    li_character_obj_t *obj = (li_character_obj_t *)li_create(&li_type_character);
-    obj->character = c;
-    return (li_object *)obj;
-}
-
 static li_object *p_is_char(li_object *args) {
     li_object *obj;
     li_parse_args(args, "o", &obj);
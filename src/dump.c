@@ -0,0 +1,160 @@
+#include "li.h"
+#include "li_gc.h"
+#include "li_lib.h"
+
+#include <stdio.h>
+#include <stdlib.h> /* free */
+#include <string.h> /* strlen */
+
+/*
+ * A heap dump starts with LI_DUMP_MAGIC, followed by records made of a tag
+ * byte and unsigned numbers, each written seven bits at a time starting with
+ * the lowest, the high bit set on every byte but the last (LEB128):
+ *
+ *   'S' id length bytes...         a type or file name, referred to by id
+ *   'O' address type size file line count address...
+ *                                  an object, the name ids of its type and the
+ *                                  file it was read from, and the addresses of
+ *                                  the objects it refers to
+ *   'R' address                    a root
+ *   'E'                            the end of the dump
+ *
+ * Name ids start at one, zero standing for an unknown file.  References may
+ * point to objects which are not on the heap and therefore not in the dump.
+ * The li-heap program reads dumps.
+ */
+#define LI_DUMP_MAGIC "LIHEAP1\n"
+
+typedef struct {
+    FILE *fp;
+    struct {
+        const char **names;
+        size_t size;
+        size_t cap;
+    } names;
+    struct {
+        li_object **objs;
+        size_t size;
+        size_t cap;
+    } refs;
+} li_dump_t;
+
+static void li_dump_num(li_dump_t *dump, size_t x)
+{
+    while (x >= 0x80) {
+        putc((int)(x & 0x7f) | 0x80, dump->fp);
+        x >>= 7;
+    }
+    putc((int)x, dump->fp);
+}
+
+static void li_dump_addr(li_dump_t *dump, li_object *obj)
+{
+    li_dump_num(dump, (size_t)obj);
+}
+
+/*
+ * Returns the id of a name, writing it out the first time it is seen.  Type
+ * names are static and file names interned, so names are told apart by their
+ * address.
+ */
+static size_t li_dump_name(li_dump_t *dump, const char *name)
+{
+    size_t i, len;
+    if (!name)
+        return 0;
+    for (i = 0; i < dump->names.size; i++)
+        if (dump->names.names[i] == name)
+            return i + 1;
+    if (dump->names.size == dump->names.cap) {
+        dump->names.cap = dump->names.cap ? LI_INC_CAP(dump->names.cap) : 32;
+        dump->names.names = li_reallocate(dump->names.names, dump->names.size,
+                dump->names.cap, sizeof(*dump->names.names));
+    }
+    dump->names.names[dump->names.size++] = name;
+    len = strlen(name);
+    putc('S', dump->fp);
+    li_dump_num(dump, dump->names.size);
+    li_dump_num(dump, len);
+    fwrite(name, 1, len, dump->fp);
+    return dump->names.size;
+}
+
+static void li_dump_ref(li_object *obj, void *data)
+{
+    li_dump_t *dump = data;
+    if (dump->refs.size == dump->refs.cap) {
+        dump->refs.cap = dump->refs.cap ? LI_INC_CAP(dump->refs.cap) : 64;
+        dump->refs.objs = li_reallocate(dump->refs.objs, dump->refs.size,
+                dump->refs.cap, sizeof(*dump->refs.objs));
+    }
+    dump->refs.objs[dump->refs.size++] = obj;
+}
+
+static void li_dump_root(li_object *obj, void *data)
+{
+    li_dump_t *dump = data;
+    putc('R', dump->fp);
+    li_dump_addr(dump, obj);
+}
+
+static void li_dump_obj(li_object *obj, size_t size, void *data)
+{
+    li_dump_t *dump = data;
+    size_t type, file = 0, line = 0, i;
+    const char *filename;
+    int lineno;
+    type = li_dump_name(dump, li_type(obj)->name);
+    if (li_is_pair(obj) && li_pair_location(obj, &filename, &lineno)) {
+        file = li_dump_name(dump, filename);
+        line = lineno;
+    }
+    dump->refs.size = 0;
+    li_gc_visit_children(obj, li_dump_ref, dump);
+    putc('O', dump->fp);
+    li_dump_addr(dump, obj);
+    li_dump_num(dump, type);
+    li_dump_num(dump, size);
+    li_dump_num(dump, file);
+    li_dump_num(dump, line);
+    li_dump_num(dump, dump->refs.size);
+    for (i = 0; i < dump->refs.size; i++)
+        li_dump_addr(dump, dump->refs.objs[i]);
+}
+
+extern void li_heap_dump(FILE *fp)
+{
+    li_dump_t dump = { NULL, { NULL, 0, 0 }, { NULL, 0, 0 } };
+    dump.fp = fp;
+    fputs(LI_DUMP_MAGIC, fp);
+    li_heap_each(li_dump_obj, &dump);
+    li_gc_visit_roots(li_dump_root, &dump);
+    putc('E', fp);
+    free(dump.names.names);
+    free(dump.refs.objs);
+}
+
+/*
+ * (heap-dump filename)
+ * Writes every object on the heap, the references between them and the roots
+ * to the given file, to be analysed with the li-heap program.
+ */
+static li_object *p_heap_dump(li_object *args)
+{
+    li_str_t *filename;
+    FILE *fp;
+    int failed;
+    li_parse_args(args, "s", &filename);
+    if (!(fp = fopen(li_string_bytes(filename), "wb")))
+        li_error_fmt("could not open output file: ~a", filename);
+    li_heap_dump(fp);
+    failed = ferror(fp);
+    if (fclose(fp) || failed)
+        li_error_fmt("could not write heap dump: ~a", filename);
+    return li_void;
+}
+
+extern void li_define_dump_functions(li_env_t *env)
+{
+    lilib_defproc(env, "heap-dump", p_heap_dump);
+}
@@ -15,30 +15,28 @@ static void mark(li_object *obj)
 {
     li_env_t *env = (li_env_t *)obj;
     int i;
-    for (; env; env = env->base) {
-        for (i = 0; i < env->len; i++) {
-            li_mark((li_object *)env->array[i].var);
-            li_mark(env->array[i].val);
-        }
+    for (i = 0; i < env->len; i++) {
+        li_mark((li_object *)env->array[i].var);
+        li_mark(env->array[i].val);
     }
+    li_mark((li_object *)env->base);
 }
 
 static void deinit(li_object *obj)
 {
     free(((li_env_t *)obj)->array);
-    free(obj);
 }
 
 const li_type_t li_type_environment = {
     .name = "environment",
+    .size = sizeof(li_env_t),
     .mark = mark,
     .deinit = deinit,
 };
 
 extern li_env_t *li_env_make(li_env_t *base)
 {
-    li_env_t *obj = li_allocate(NULL, 1, sizeof(*obj));
-    li_object_init((li_object *)obj, &li_type_environment);
+    li_env_t *obj = (li_env_t *)li_create(&li_type_environment);
     obj->cap = 4;
     obj->len = 0;
     obj->array = li_allocate(NULL, obj->cap, sizeof(*obj->array));
@@ -57,6 +55,7 @@ extern int li_env_assign(li_env_t *env, li_sym_t *var, li_object *val)
     while (env) {
         for (i = 0; i < env->len; i++)
             if (env->array[i].var == var) {
+                li_gc_write_barrier((li_object *)env, env->array[i].val);
                 env->array[i].val = val;
                 return 1;
             }
@@ -70,6 +69,7 @@ extern void li_env_define(li_env_t *env, li_sym_t *var, li_object *val)
     int i;
     for (i = 0; i < env->len; i++) {
         if (env->array[i].var == var) {
+            li_gc_write_barrier((li_object *)env, env->array[i].val);
             env->array[i].val = val;
             return;
         }
@@ -107,8 +107,10 @@ extern void li_env_append(li_env_t *env, li_sym_t *var, li_object *val)
         li_error_fmt("not a variable: ~a", var);
     if (env->len == env->cap) {
         env->cap *= 2;
-        env->array = li_allocate(env->array, env->cap, sizeof(*env->array));
+        env->array = li_reallocate(env->array, env->len,
+                env->cap, sizeof(*env->array));
     }
+    li_gc_write_barrier((li_object *)env, NULL);
     env->array[env->len].var = var;
     env->array[env->len].val = val;
     env->len++;
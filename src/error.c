@@ -30,15 +30,10 @@ extern li_object *li_stack_trace(void)
 
 static int get_metadata(li_object *expr, const char **filename, int *lineno)
 {
-    li_pair_t *p;
     if (!li_is_pair(expr))
         return 0;
-    p = (li_pair_t *)expr;
-    if (p->lineno) {
-        *filename = p->filename;
-        *lineno = p->lineno;
+    if (li_pair_location(expr, filename, lineno))
         return 1;
-    }
     return get_metadata(li_cdr(expr), filename, lineno);
 }
 
@@ -93,13 +88,19 @@ extern void li_error_fmt(const char *msg, ...)
 
 extern int li_try(void (*f1)(li_object *), void (*f2)(li_object *), li_object *arg)
 {
+    int sp = li_gc_push_root(&arg);
     int ret = setjmp(buf);
     if (ret) {
-        if (f2)
+        li_gc_pop_roots(sp + 1);
+        li_region_abort();
+        if (f2) {
             f2(arg);
-        else
+        } else {
+            li_gc_pop_roots(sp);
             return ret;
+        }
     }
     f1(arg);
+    li_gc_pop_roots(sp);
     return 0;
 }
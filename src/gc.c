@@ -0,0 +1,1177 @@
+#define _POSIX_C_SOURCE 200112L /* clock_gettime */
+
+#include "li.h"
+#include "li_gc.h"
+#include "li_lib.h"
+#include "li_num.h"
+
+#include <errno.h> /* EMFILE, ENFILE */
+#include <pthread.h>
+#include <sched.h> /* sched_yield */
+#include <stdio.h> /* fputs */
+#include <stdlib.h> /* abort */
+#include <time.h> /* clock_gettime */
+
+#ifndef LI_GC_THRESHOLD
+#define LI_GC_THRESHOLD (4 * 1024 * 1024)
+#endif
+
+#ifndef LI_GC_NURSERY_SIZE
+#define LI_GC_NURSERY_SIZE (LI_GC_THRESHOLD / 4)
+#endif
+
+/* Bytes allocated between two slices of an incremental collection. */
+#ifndef LI_GC_SLICE_SIZE
+#define LI_GC_SLICE_SIZE (LI_GC_NURSERY_SIZE / 16)
+#endif
+
+/* Pairs followed along a cdr chain before the rest goes back on the stack. */
+#ifndef LI_GC_CHAIN_LENGTH
+#define LI_GC_CHAIN_LENGTH 1024
+#endif
+
+/* Number of threads which mark and sweep a full collection. */
+#ifndef LI_GC_THREADS
+#define LI_GC_THREADS 1
+#endif
+
+#define LI_GC_MAX_THREADS 64
+
+/* Initial pause budget in microseconds, zero meaning unbounded. */
+#ifndef LI_GC_PAUSE_BUDGET
+#define LI_GC_PAUSE_BUDGET 0
+#endif
+
+/* Bytes a region may allocate before collections resume, dissolving it. */
+#ifndef LI_GC_REGION_SIZE
+#define LI_GC_REGION_SIZE (4 * LI_GC_THRESHOLD)
+#endif
+
+#ifdef __GNUC__
+#define li_prefetch(obj)        __builtin_prefetch(obj)
+#else
+#define li_prefetch(obj)        ((void)(obj))
+#endif
+
+/*
+ * The root set.  Protected objects are values registered from C, roots are the
+ * addresses of C variables which hold objects and the eval stack holds the
+ * addresses of temporaries belonging to active evaluations.
+ */
+static struct {
+    li_object **protected;
+    size_t num_protected;
+    size_t cap_protected;
+    li_object ***roots;
+    size_t num_roots;
+    size_t cap_roots;
+    li_object ***stack;
+    int sp;
+    int cap;
+} _roots = { NULL, 0, 0, NULL, 0, 0, NULL, 0, 0 };
+
+/*
+ * Marked objects whose children have yet to be marked.  Marked objects which
+ * are not on the stack are black, unmarked ones are white.  Marking works off
+ * this stack rather than recursing, so deep structures cannot overflow the C
+ * stack.
+ */
+static struct {
+    li_object **objs;
+    size_t size;
+    size_t cap;
+} _gray = { NULL, 0, 0 };
+
+/*
+ * Every weak box, ephemeron and guardian which was alive after the last
+ * collection.
+ * Their references are not traced but looked at once marking is over, see
+ * li_gc_weak.
+ */
+static struct {
+    li_object **objs;
+    size_t size;
+    size_t cap;
+} _weak = { NULL, 0, 0 };
+
+/*
+ * Every slice which was alive after the last collection along with the object
+ * whose storage it shares, see li_gc_add_slice.  Slices are added in the order
+ * they are made, so the ones from young to size are those made since.
+ */
+static struct {
+    struct {
+        li_object *slice;
+        li_object *parent;
+        li_unshare_f *unshare;
+    } *slices;
+    size_t size;
+    size_t cap;
+    size_t young;
+} _slices = { NULL, 0, 0, 0 };
+
+/*
+ * A minor collection runs whenever LI_GC_NURSERY_SIZE bytes have been
+ * allocated since the last one and a full collection once the old generation
+ * has grown past the threshold.  With a pause budget, a full collection marks
+ * in slices of at most that many microseconds, one every LI_GC_SLICE_SIZE
+ * bytes of allocation, and no minor collection runs until it is done.
+ */
+static struct {
+    size_t old;
+    size_t threshold;
+    li_bool_t minor;
+    li_bool_t marking;
+    li_bool_t requested;    /* run a full collection at the next safe point */
+    size_t next_slice;
+    long budget;
+    int regions;            /* li_region_begins not ended yet */
+} _gc = {
+    0, LI_GC_THRESHOLD, LI_FALSE, LI_FALSE, LI_FALSE, 0, LI_GC_PAUSE_BUDGET, 0
+};
+
+/* Collections so far and how long they stopped the program for. */
+static struct {
+    size_t minor;
+    size_t major;
+    long pause_total;
+    long pause_max;
+    size_t pauses[LI_GC_PAUSE_BUCKETS];
+} _stats;
+
+/*
+ * With more than one thread, the stop-the-world part of a full collection is
+ * shared between the main thread and a pool of helpers.  Each marks off its
+ * own work-stealing deque (Chase and Lev's, with Le et al.'s memory orderings)
+ * and takes from the others' when it runs dry.  The sweep hands out pages
+ * from a shared counter.
+ */
+typedef struct li_deque_buf_t li_deque_buf_t;
+
+struct li_deque_buf_t {
+    long cap;
+    li_object **objs;
+    li_deque_buf_t *next;   /* next retired buffer */
+};
+
+typedef struct {
+    pthread_t thread;
+    long top;                   /* where other threads steal from */
+    long bottom;                /* where the owner pushes and takes */
+    li_deque_buf_t *buf;
+    li_deque_buf_t *retired;    /* outgrown buffers thieves may still read */
+    unsigned int seed;
+    unsigned long round;
+    size_t promoted;
+} li_worker_t;
+
+static struct {
+    li_worker_t workers[LI_GC_MAX_THREADS];
+    int size;           /* threads taking part, counting the main one */
+    int started;        /* helper threads running */
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    pthread_cond_t done;
+    void (*job)(li_worker_t *);
+    unsigned long round;
+    int busy;           /* helpers still working on the current job */
+    int idle;           /* threads which ran out of marking work */
+    size_t next;        /* next page to sweep */
+    size_t pages;
+} _pool = {
+    .size = LI_GC_THREADS,
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .wake = PTHREAD_COND_INITIALIZER,
+    .done = PTHREAD_COND_INITIALIZER,
+};
+
+/* The worker the current thread is marking for, if any. */
+static __thread li_worker_t *_self = NULL;
+
+/* Helper threads cannot raise errors, so running out of memory is fatal. */
+static void *li_gc_malloc(size_t size)
+{
+    void *ptr = malloc(size);
+    if (!ptr) {
+        fputs("li: out of memory while collecting garbage\n", stderr);
+        abort();
+    }
+    return ptr;
+}
+
+static li_deque_buf_t *li_deque_buf(long cap)
+{
+    li_deque_buf_t *buf = li_gc_malloc(sizeof(*buf));
+    buf->cap = cap;
+    buf->objs = li_gc_malloc(cap * sizeof(*buf->objs));
+    buf->next = NULL;
+    return buf;
+}
+
+static void li_deque_grow(li_worker_t *w, long top, long bottom)
+{
+    li_deque_buf_t *old = w->buf, *buf = li_deque_buf(2 * old->cap);
+    long i;
+    for (i = top; i < bottom; i++)
+        buf->objs[i & (buf->cap - 1)] = old->objs[i & (old->cap - 1)];
+    old->next = w->retired;
+    w->retired = old;
+    __atomic_store_n(&w->buf, buf, __ATOMIC_RELEASE);
+}
+
+static void li_deque_push(li_worker_t *w, li_object *obj)
+{
+    long bottom = __atomic_load_n(&w->bottom, __ATOMIC_RELAXED);
+    long top = __atomic_load_n(&w->top, __ATOMIC_ACQUIRE);
+    if (bottom - top >= w->buf->cap)
+        li_deque_grow(w, top, bottom);
+    __atomic_store_n(&w->buf->objs[bottom & (w->buf->cap - 1)], obj,
+            __ATOMIC_RELAXED);
+    __atomic_store_n(&w->bottom, bottom + 1, __ATOMIC_RELEASE);
+}
+
+static li_object *li_deque_take(li_worker_t *w)
+{
+    long bottom = __atomic_load_n(&w->bottom, __ATOMIC_RELAXED) - 1;
+    long top;
+    li_object *obj = NULL;
+    __atomic_store_n(&w->bottom, bottom, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    top = __atomic_load_n(&w->top, __ATOMIC_RELAXED);
+    if (top <= bottom) {
+        obj = __atomic_load_n(&w->buf->objs[bottom & (w->buf->cap - 1)],
+                __ATOMIC_RELAXED);
+        if (top < bottom)
+            return obj;
+        /* Racing thieves for the last object. */
+        if (!__atomic_compare_exchange_n(&w->top, &top, top + 1, 0,
+                    __ATOMIC_SEQ_CST, __ATOMIC_RELAXED))
+            obj = NULL;
+    }
+    __atomic_store_n(&w->bottom, bottom + 1, __ATOMIC_RELAXED);
+    return obj;
+}
+
+static li_object *li_deque_steal(li_worker_t *w)
+{
+    long top = __atomic_load_n(&w->top, __ATOMIC_ACQUIRE);
+    long bottom;
+    li_deque_buf_t *buf;
+    li_object *obj;
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    bottom = __atomic_load_n(&w->bottom, __ATOMIC_ACQUIRE);
+    if (top >= bottom)
+        return NULL;
+    buf = __atomic_load_n(&w->buf, __ATOMIC_ACQUIRE);
+    obj = __atomic_load_n(&buf->objs[top & (buf->cap - 1)], __ATOMIC_RELAXED);
+    if (!__atomic_compare_exchange_n(&w->top, &top, top + 1, 0,
+                __ATOMIC_SEQ_CST, __ATOMIC_RELAXED))
+        return NULL;
+    return obj;
+}
+
+static li_bool_t li_deque_is_empty(li_worker_t *w)
+{
+    return __atomic_load_n(&w->bottom, __ATOMIC_ACQUIRE)
+        <= __atomic_load_n(&w->top, __ATOMIC_ACQUIRE);
+}
+
+static void li_gc_push(li_object *obj)
+{
+    if (_gray.size == _gray.cap) {
+        _gray.cap = _gray.cap ? LI_INC_CAP(_gray.cap) : 1024;
+        _gray.objs = li_reallocate(_gray.objs, _gray.size,
+                _gray.cap, sizeof(*_gray.objs));
+    }
+    _gray.objs[_gray.size++] = obj;
+}
+
+static void li_gc_gray(li_object *obj)
+{
+    /* The object is read once it is popped, which is usually soon. */
+    li_prefetch(obj);
+    if (_self)
+        li_deque_push(_self, obj);
+    else
+        li_gc_push(obj);
+}
+
+/*
+ * While set, li_mark reports each reference to fn instead of marking it, which
+ * lets the heap be walked with the mark functions every type already has.
+ */
+static struct {
+    li_visit_f *fn;
+    void *data;
+} _visit = { NULL, NULL };
+
+extern void li_mark(li_object *obj)
+{
+    if (_visit.fn) {
+        if (obj)
+            _visit.fn(obj, _visit.data);
+        return;
+    }
+    if (obj && li_heap_mark(obj, _gc.minor) && li_type(obj)->mark)
+        li_gc_gray(obj);
+}
+
+/*
+ * Roots.
+ */
+
+extern void li_gc_protect(li_object *obj)
+{
+    if (_roots.num_protected == _roots.cap_protected) {
+        _roots.cap_protected = _roots.cap_protected
+            ? LI_INC_CAP(_roots.cap_protected) : 16;
+        _roots.protected = li_reallocate(_roots.protected,
+                _roots.num_protected, _roots.cap_protected,
+                sizeof(*_roots.protected));
+    }
+    _roots.protected[_roots.num_protected++] = obj;
+}
+
+extern void li_gc_unprotect(li_object *obj)
+{
+    size_t i = _roots.num_protected;
+    while (i-- > 0) {
+        if (_roots.protected[i] == obj) {
+            _roots.protected[i] = _roots.protected[--_roots.num_protected];
+            return;
+        }
+    }
+}
+
+extern void li_gc_add_root(li_object **ref)
+{
+    if (_roots.num_roots == _roots.cap_roots) {
+        _roots.cap_roots = _roots.cap_roots
+            ? LI_INC_CAP(_roots.cap_roots) : 16;
+        _roots.roots = li_reallocate(_roots.roots, _roots.num_roots,
+                _roots.cap_roots, sizeof(*_roots.roots));
+    }
+    _roots.roots[_roots.num_roots++] = ref;
+}
+
+extern void li_gc_remove_root(li_object **ref)
+{
+    size_t i = _roots.num_roots;
+    while (i-- > 0) {
+        if (_roots.roots[i] == ref) {
+            _roots.roots[i] = _roots.roots[--_roots.num_roots];
+            return;
+        }
+    }
+}
+
+extern int li_gc_push_root(li_object **ref)
+{
+    if (_roots.sp == _roots.cap) {
+        _roots.cap = _roots.cap ? LI_INC_CAP(_roots.cap) : 64;
+        _roots.stack = li_reallocate(_roots.stack, _roots.sp,
+                _roots.cap, sizeof(*_roots.stack));
+    }
+    _roots.stack[_roots.sp] = ref;
+    return _roots.sp++;
+}
+
+extern void li_gc_pop_roots(int sp)
+{
+    _roots.sp = sp;
+}
+
+/*
+ * Garbage collector.
+ */
+
+static void li_mark_roots(void)
+{
+    size_t i;
+    int j;
+    for (i = 0; i < _roots.num_protected; i++)
+        li_mark(_roots.protected[i]);
+    for (i = 0; i < _roots.num_roots; i++)
+        li_mark(*_roots.roots[i]);
+    for (j = 0; j < _roots.sp; j++)
+        li_mark(*_roots.stack[j]);
+    li_mark(li_stack_trace());
+}
+
+extern void li_gc_visit_roots(li_visit_f *fn, void *data)
+{
+    _visit.fn = fn;
+    _visit.data = data;
+    li_mark_roots();
+    _visit.fn = NULL;
+}
+
+extern void li_gc_visit_children(li_object *obj, li_visit_f *fn, void *data)
+{
+    if (!li_type(obj)->mark)
+        return;
+    _visit.fn = fn;
+    _visit.data = data;
+    li_type(obj)->mark(obj);
+    _visit.fn = NULL;
+}
+
+static long li_gc_elapsed_us(const struct timespec *start)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) * 1000000
+        + (now.tv_nsec - start->tv_nsec) / 1000;
+}
+
+/*
+ * Marks the children of a gray object.  Lists are followed along their cdrs
+ * without going through the stack, which would otherwise hold the whole spine
+ * of a long list.  Returns the number of objects scanned.
+ */
+static size_t li_gc_scan(li_object *obj)
+{
+    size_t n = 1;
+    while (li_is_pair(obj)) {
+        li_object *cdr = ((li_pair_t *)obj)->cdr;
+        li_prefetch(cdr);
+        li_mark(((li_pair_t *)obj)->car);
+        if (!cdr || !li_heap_mark(cdr, _gc.minor))
+            return n;
+        if (n++ == LI_GC_CHAIN_LENGTH) {
+            li_gc_gray(cdr);
+            return n;
+        }
+        obj = cdr;
+    }
+    if (li_type(obj)->mark)
+        li_type(obj)->mark(obj);
+    return n;
+}
+
+/*
+ * Blackens gray objects until there are none left, or until budget
+ * microseconds have passed if budget is positive.  Returns whether marking
+ * is complete.
+ */
+static li_bool_t li_gc_drain(long budget)
+{
+    struct timespec start;
+    size_t n = 0;
+    if (budget > 0)
+        clock_gettime(CLOCK_MONOTONIC, &start);
+    while (_gray.size) {
+        n += li_gc_scan(_gray.objs[--_gray.size]);
+        if (budget > 0 && n >= 256) {
+            if (li_gc_elapsed_us(&start) >= budget)
+                return LI_FALSE;
+            n = 0;
+        }
+    }
+    return LI_TRUE;
+}
+
+/*
+ * The helper threads.
+ */
+
+static void *li_gc_worker(void *arg)
+{
+    li_worker_t *w = arg;
+    void (*job)(li_worker_t *);
+    _self = w;
+    pthread_mutex_lock(&_pool.lock);
+    for (;;) {
+        while (w->round == _pool.round)
+            pthread_cond_wait(&_pool.wake, &_pool.lock);
+        w->round = _pool.round;
+        if (!(job = _pool.job))
+            break;
+        pthread_mutex_unlock(&_pool.lock);
+        job(w);
+        pthread_mutex_lock(&_pool.lock);
+        if (--_pool.busy == 0)
+            pthread_cond_signal(&_pool.done);
+    }
+    pthread_mutex_unlock(&_pool.lock);
+    return NULL;
+}
+
+/* The helpers do not survive a fork, so the child starts its own. */
+static void li_gc_forked(void)
+{
+    _pool.started = 0;
+}
+
+static void li_gc_start_threads(void)
+{
+    static li_bool_t registered = LI_FALSE;
+    int i;
+    if (!registered) {
+        pthread_atfork(NULL, NULL, li_gc_forked);
+        registered = LI_TRUE;
+    }
+    for (i = 0; i < _pool.size; i++)
+        if (!_pool.workers[i].buf)
+            _pool.workers[i].buf = li_deque_buf(1024);
+    for (i = _pool.started + 1; i < _pool.size; i++) {
+        li_worker_t *w = &_pool.workers[i];
+        w->round = _pool.round;
+        w->seed = i;
+        if (pthread_create(&w->thread, NULL, li_gc_worker, w)) {
+            _pool.size = i;
+            break;
+        }
+    }
+    _pool.started = _pool.size - 1;
+}
+
+static void li_gc_stop_threads(void)
+{
+    int i;
+    if (!_pool.started)
+        return;
+    pthread_mutex_lock(&_pool.lock);
+    _pool.job = NULL;
+    _pool.round++;
+    pthread_cond_broadcast(&_pool.wake);
+    pthread_mutex_unlock(&_pool.lock);
+    for (i = 1; i <= _pool.started; i++)
+        pthread_join(_pool.workers[i].thread, NULL);
+    _pool.started = 0;
+}
+
+/* Runs job on every thread of the pool, including this one. */
+static void li_gc_run(void (*job)(li_worker_t *))
+{
+    pthread_mutex_lock(&_pool.lock);
+    _pool.job = job;
+    _pool.busy = _pool.started;
+    _pool.round++;
+    pthread_cond_broadcast(&_pool.wake);
+    pthread_mutex_unlock(&_pool.lock);
+    _self = &_pool.workers[0];
+    job(_self);
+    _self = NULL;
+    pthread_mutex_lock(&_pool.lock);
+    while (_pool.busy)
+        pthread_cond_wait(&_pool.done, &_pool.lock);
+    pthread_mutex_unlock(&_pool.lock);
+}
+
+static li_object *li_gc_steal(li_worker_t *w)
+{
+    int i, start;
+    li_object *obj;
+    w->seed = w->seed * 1103515245 + 12345;
+    start = (w->seed >> 16) % _pool.size;
+    for (i = 0; i < _pool.size; i++) {
+        li_worker_t *victim = &_pool.workers[(start + i) % _pool.size];
+        if (victim != w && (obj = li_deque_steal(victim)))
+            return obj;
+    }
+    return NULL;
+}
+
+static li_bool_t li_gc_has_work(void)
+{
+    int i;
+    for (i = 0; i < _pool.size; i++)
+        if (!li_deque_is_empty(&_pool.workers[i]))
+            return LI_TRUE;
+    return LI_FALSE;
+}
+
+/*
+ * Marking is over once every thread is idle: a thread only goes idle with an
+ * empty deque, and only busy threads push.
+ */
+static void li_gc_mark_job(li_worker_t *w)
+{
+    li_object *obj;
+    for (;;) {
+        while ((obj = li_deque_take(w)) || (obj = li_gc_steal(w)))
+            li_gc_scan(obj);
+        __atomic_add_fetch(&_pool.idle, 1, __ATOMIC_SEQ_CST);
+        while (!li_gc_has_work()) {
+            if (__atomic_load_n(&_pool.idle, __ATOMIC_SEQ_CST) == _pool.size)
+                return;
+            sched_yield();
+        }
+        __atomic_sub_fetch(&_pool.idle, 1, __ATOMIC_SEQ_CST);
+    }
+}
+
+static void li_gc_sweep_job(li_worker_t *w)
+{
+    size_t i;
+    w->promoted = 0;
+    while ((i = __atomic_fetch_add(&_pool.next, 1, __ATOMIC_RELAXED))
+            < _pool.pages)
+        li_heap_sweep_page(i, &w->promoted);
+}
+
+/*
+ * The datum of an ephemeron whose key survives is marked, which may make more
+ * keys survive, until nothing changes.
+ */
+static void li_gc_ephemerons(void)
+{
+    li_bool_t changed;
+    size_t i;
+    do {
+        changed = LI_FALSE;
+        for (i = 0; i < _weak.size; i++) {
+            li_ephemeron_t *eph = (li_ephemeron_t *)_weak.objs[i];
+            if (li_is_ephemeron(eph) && !eph->broken
+                    && li_heap_live((li_object *)eph, _gc.minor)
+                    && li_heap_live(eph->key, _gc.minor)
+                    && !li_heap_live(eph->datum, _gc.minor)) {
+                li_mark(eph->datum);
+                changed = LI_TRUE;
+            }
+        }
+        li_gc_drain(0);
+    } while (changed);
+}
+
+/*
+ * Queues the registered objects which did not survive on their guardians and
+ * brings them back to life, along with everything they refer to.  Whether an
+ * object survived is decided for all guardians before anything is revived.
+ */
+static void li_gc_guardians(void)
+{
+    size_t i, j, n;
+    for (i = 0; i < _weak.size; i++) {
+        li_guardian_t *guardian = (li_guardian_t *)_weak.objs[i];
+        if (!li_is_guardian(guardian)
+                || !li_heap_live((li_object *)guardian, _gc.minor))
+            continue;
+        for (j = n = 0; j < guardian->num_pending; j++) {
+            li_object *obj = guardian->pending[j];
+            if (li_heap_live(obj, _gc.minor)) {
+                guardian->pending[n++] = obj;
+                continue;
+            }
+            if (guardian->num_ready == guardian->cap_ready) {
+                guardian->cap_ready = guardian->cap_ready
+                    ? LI_INC_CAP(guardian->cap_ready) : 16;
+                guardian->ready = li_reallocate(guardian->ready,
+                        guardian->num_ready, guardian->cap_ready,
+                        sizeof(*guardian->ready));
+            }
+            guardian->ready[guardian->num_ready++] = obj;
+        }
+        guardian->num_pending = n;
+    }
+    for (i = 0; i < _weak.size; i++) {
+        li_guardian_t *guardian = (li_guardian_t *)_weak.objs[i];
+        if (li_is_guardian(guardian)
+                && li_heap_live((li_object *)guardian, _gc.minor))
+            for (j = 0; j < guardian->num_ready; j++)
+                li_mark(guardian->ready[j]);
+    }
+    li_gc_drain(0);
+}
+
+/*
+ * Slices of an object which is about to be swept get storage of their own,
+ * while the object's is still there to copy from.  A slice is never older
+ * than its parent, so only the young ones can lose it in a minor collection
+ * or a region.
+ */
+static void li_gc_slices(void)
+{
+    size_t i, n;
+    i = n = _gc.minor || li_heap_region_open() ? _slices.young : 0;
+    for (; i < _slices.size; i++) {
+        if (!li_heap_live(_slices.slices[i].slice, _gc.minor))
+            continue;
+        if (!li_heap_live(_slices.slices[i].parent, _gc.minor)) {
+            _slices.slices[i].unshare(_slices.slices[i].slice);
+            continue;
+        }
+        _slices.slices[n++] = _slices.slices[i];
+    }
+    _slices.size = n;
+    /* The survivors of a region are young still, those of a collection old. */
+    if (!li_heap_region_open())
+        _slices.young = n;
+}
+
+/*
+ * Runs once everything reachable is marked, before the sweep.  Objects kept
+ * alive by ephemerons and guardians are marked first, then weak references to
+ * objects which are about to be swept are cleared and weak objects which are
+ * about to be swept themselves are forgotten.  A weak reference to an object
+ * revived by a guardian is therefore kept.
+ */
+static void li_gc_weak(void)
+{
+    size_t i, n;
+    li_gc_ephemerons();
+    li_gc_guardians();
+    li_gc_ephemerons();
+    for (i = n = 0; i < _weak.size; i++) {
+        li_object *obj = _weak.objs[i];
+        if (!li_heap_live(obj, _gc.minor))
+            continue;
+        if (li_is_weak_box(obj)) {
+            li_weak_box_t *box = (li_weak_box_t *)obj;
+            if (!li_heap_live(box->value, _gc.minor)) {
+                box->value = li_false;
+                box->broken = LI_TRUE;
+            }
+        } else if (li_is_ephemeron(obj)) {
+            li_ephemeron_t *eph = (li_ephemeron_t *)obj;
+            if (!li_heap_live(eph->key, _gc.minor)) {
+                eph->key = eph->datum = li_false;
+                eph->broken = LI_TRUE;
+            }
+        }
+        _weak.objs[n++] = obj;
+    }
+    _weak.size = n;
+    li_gc_slices();
+    li_pair_locations_sweep(_gc.minor);
+}
+
+static size_t li_gc_finish_parallel(size_t *promoted)
+{
+    li_worker_t *w = &_pool.workers[0];
+    li_deque_buf_t *buf;
+    int i;
+    li_gc_start_threads();
+    while (_gray.size)
+        li_deque_push(w, _gray.objs[--_gray.size]);
+    _pool.idle = 0;
+    li_gc_run(li_gc_mark_job);
+    li_gc_weak();
+    _pool.pages = li_heap_sweep_begin();
+    _pool.next = 0;
+    li_gc_run(li_gc_sweep_job);
+    *promoted = 0;
+    for (i = 0; i < _pool.size; i++) {
+        w = &_pool.workers[i];
+        *promoted += w->promoted;
+        while ((buf = w->retired)) {
+            w->retired = buf->next;
+            free(buf->objs);
+            free(buf);
+        }
+    }
+    return li_heap_sweep_end();
+}
+
+static void li_gc_free_threads(void)
+{
+    int i;
+    li_gc_stop_threads();
+    for (i = 0; i < LI_GC_MAX_THREADS; i++) {
+        li_worker_t *w = &_pool.workers[i];
+        if (w->buf) {
+            free(w->buf->objs);
+            free(w->buf);
+            w->buf = NULL;
+        }
+    }
+}
+
+/*
+ * A minor collection only marks young objects.  Old ones are assumed to be
+ * alive, so the young objects they point to are found through the remembered
+ * set instead.
+ */
+static void li_gc_minor(void)
+{
+    size_t promoted;
+    _stats.minor++;
+    _gc.minor = LI_TRUE;
+    li_mark_roots();
+    li_heap_mark_remembered();
+    li_gc_drain(0);
+    li_gc_weak();
+    li_heap_sweep(LI_TRUE, &promoted);
+    _gc.old += promoted;
+    _gc.minor = LI_FALSE;
+}
+
+static void li_gc_finish(void)
+{
+    size_t promoted, live;
+    _stats.major++;
+    if (_pool.size > 1) {
+        _gc.old = li_gc_finish_parallel(&promoted);
+    } else {
+        li_gc_drain(0);
+        li_gc_weak();
+        _gc.old = li_heap_sweep(LI_FALSE, &promoted);
+    }
+    /* Whatever was allocated while marking survived without being traced, so
+     * only count the rest towards the next threshold. */
+    live = _gc.old - promoted;
+    _gc.threshold = live > LI_GC_THRESHOLD / 2
+        ? _gc.old + live : _gc.old + LI_GC_THRESHOLD / 2;
+    _gc.marking = LI_FALSE;
+    li_heap_allocate_black(LI_FALSE);
+}
+
+/*
+ * Incremental collections mark a snapshot of the heap taken when they start:
+ * the roots are marked right away, objects allocated while marking are born
+ * black and the write barrier marks any reference which is about to be
+ * overwritten.  Whatever was reachable at the start is therefore marked by the
+ * time the gray stack runs dry, without scanning the roots again.
+ */
+static void li_gc_start(void)
+{
+    _gc.marking = LI_TRUE;
+    li_heap_allocate_black(LI_TRUE);
+    li_mark_roots();
+    _gc.next_slice = li_heap_allocated();
+}
+
+static void li_gc_slice(void)
+{
+    /* Give up on incrementality if the mutator outruns the marker. */
+    long budget = _gc.old + li_heap_allocated() < 2 * _gc.threshold
+        ? _gc.budget : 0;
+    if (li_gc_drain(budget))
+        li_gc_finish();
+    else
+        _gc.next_slice = li_heap_allocated() + LI_GC_SLICE_SIZE;
+}
+
+extern void li_gc_collect(void)
+{
+    li_heap_region_dissolve();
+    if (!_gc.marking)
+        li_mark_roots();
+    li_gc_finish();
+}
+
+static void li_gc_pause(const struct timespec *start)
+{
+    long usec = li_gc_elapsed_us(start);
+    int i = 0;
+    while (i < LI_GC_PAUSE_BUCKETS - 1 && usec >= 2L << i)
+        i++;
+    _stats.pauses[i]++;
+    _stats.pause_total += usec;
+    if (usec > _stats.pause_max)
+        _stats.pause_max = usec;
+}
+
+extern void li_gc_safe_point(void)
+{
+    struct timespec start;
+    if (!_gc.requested && (li_heap_region_open()
+                ? li_heap_region_allocated() < LI_GC_REGION_SIZE
+                : li_heap_allocated() < (_gc.marking ? _gc.next_slice
+                    : LI_GC_NURSERY_SIZE)))
+        return;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    li_heap_region_dissolve();
+    if (_gc.requested) {
+        _gc.requested = LI_FALSE;
+        li_gc_collect();
+    } else if (_gc.marking) {
+        li_gc_slice();
+    } else {
+        li_gc_minor();
+        if (_gc.old >= _gc.threshold) {
+            if (_gc.budget > 0) {
+                li_gc_start();
+                li_gc_slice();
+            } else {
+                li_gc_collect();
+            }
+        }
+    }
+    li_gc_pause(&start);
+}
+
+extern void li_gc_write_barrier(li_object *obj, li_object *old)
+{
+    if (_gc.marking)
+        li_mark(old);
+    li_heap_remember(obj);
+}
+
+extern void li_gc_read_barrier(li_object *obj)
+{
+    if (_gc.marking)
+        li_mark(obj);
+}
+
+extern void li_gc_register_weak(li_object *obj)
+{
+    if (_weak.size == _weak.cap) {
+        _weak.cap = _weak.cap ? LI_INC_CAP(_weak.cap) : 64;
+        _weak.objs = li_reallocate(_weak.objs, _weak.size,
+                _weak.cap, sizeof(*_weak.objs));
+    }
+    _weak.objs[_weak.size++] = obj;
+}
+
+extern void li_gc_add_slice(li_object *slice, li_object *parent,
+        li_unshare_f *unshare)
+{
+    if (_slices.size == _slices.cap) {
+        _slices.cap = _slices.cap ? LI_INC_CAP(_slices.cap) : 64;
+        _slices.slices = li_reallocate(_slices.slices, _slices.size,
+                _slices.cap, sizeof(*_slices.slices));
+    }
+    _slices.slices[_slices.size].slice = slice;
+    _slices.slices[_slices.size].parent = parent;
+    _slices.slices[_slices.size].unshare = unshare;
+    _slices.size++;
+}
+
+extern void li_gc_unshare_slices(li_object *parent)
+{
+    size_t i, n, young = _slices.young;
+    for (i = n = 0; i < _slices.size; i++) {
+        if (_slices.slices[i].parent == parent) {
+            _slices.slices[i].unshare(_slices.slices[i].slice);
+            if (i < _slices.young)
+                young--;
+            continue;
+        }
+        _slices.slices[n++] = _slices.slices[i];
+    }
+    _slices.size = n;
+    _slices.young = young;
+}
+
+extern li_bool_t li_gc_reclaim_fds(int err)
+{
+    if (err != EMFILE && err != ENFILE)
+        return LI_FALSE;
+    li_gc_collect();
+    return LI_TRUE;
+}
+
+extern void li_region_begin(void)
+{
+    if (_gc.regions++)
+        return;
+    /* Objects born black would survive the region. */
+    if (_gc.marking)
+        li_gc_collect();
+    li_heap_region_begin();
+}
+
+/*
+ * Ending a region is a minor collection restricted to the region, which the
+ * roots and the remembered set are enough to trace.
+ */
+extern void li_region_end(void)
+{
+    if (!_gc.regions || --_gc.regions || !li_heap_region_open())
+        return;
+    li_heap_region_mark();
+    li_mark_roots();
+    li_heap_mark_remembered();
+    li_gc_drain(0);
+    li_gc_weak();
+    li_heap_region_end();
+}
+
+extern void li_region_abort(void)
+{
+    li_heap_region_dissolve();
+    _gc.regions = 0;
+}
+
+extern void li_gc_set_pause_budget(long usec)
+{
+    _gc.budget = usec > 0 ? usec : 0;
+}
+
+extern long li_gc_pause_budget(void)
+{
+    return _gc.budget;
+}
+
+extern void li_gc_set_threads(int n)
+{
+    li_gc_stop_threads();
+    _pool.size = n < 1 ? 1 : n > LI_GC_MAX_THREADS ? LI_GC_MAX_THREADS : n;
+}
+
+extern int li_gc_threads(void)
+{
+    return _pool.size;
+}
+
+extern void li_gc_stats(li_gc_stats_t *stats)
+{
+    int i;
+    li_heap_stats(stats);
+    stats->minor_collections = _stats.minor;
+    stats->major_collections = _stats.major;
+    stats->pause_total_us = _stats.pause_total;
+    stats->pause_max_us = _stats.pause_max;
+    for (i = 0; i < LI_GC_PAUSE_BUCKETS; i++)
+        stats->pauses[i] = _stats.pauses[i];
+}
+
+extern void li_cleanup(li_env_t *env)
+{
+    if (env) {
+        li_mark((li_object *)env);
+        li_gc_collect();
+        return;
+    }
+    li_gc_free_threads();
+    li_heap_free();
+    _gc.marking = LI_FALSE;
+    _gc.regions = 0;
+    free(_gray.objs);
+    _gray.objs = NULL;
+    _gray.size = _gray.cap = 0;
+    free(_weak.objs);
+    _weak.objs = NULL;
+    _weak.size = _weak.cap = 0;
+    free(_slices.slices);
+    _slices.slices = NULL;
+    _slices.size = _slices.cap = _slices.young = 0;
+    free(_roots.protected);
+    free(_roots.roots);
+    free(_roots.stack);
+    _roots.protected = NULL;
+    _roots.roots = NULL;
+    _roots.stack = NULL;
+    _roots.num_protected = _roots.cap_protected = 0;
+    _roots.num_roots = _roots.cap_roots = 0;
+    _roots.sp = _roots.cap = 0;
+}
+
+/*
+ * (gc-pause-budget-us)
+ * (gc-pause-budget-us n)
+ * Returns the longest time in microseconds a full collection may stop the
+ * program for, or sets it when n is given.  A full collection then marks
+ * incrementally, a slice of at most n microseconds at a time.  Zero, the
+ * default, means no limit.
+ */
+static li_object *p_gc_pause_budget_us(li_object *args)
+{
+    int usec;
+    if (!args)
+        return (li_object *)li_num_with_int(li_gc_pause_budget());
+    li_parse_args(args, "i", &usec);
+    if (usec < 0)
+        li_error_fmt("not a valid budget: ~a", li_car(args));
+    li_gc_set_pause_budget(usec);
+    return li_void;
+}
+
+/*
+ * (gc-threads)
+ * (gc-threads n)
+ * Returns the number of threads which mark and sweep a full collection, or
+ * sets it when n is given.
+ */
+static li_object *p_gc_threads(li_object *args)
+{
+    int n;
+    if (!args)
+        return (li_object *)li_num_with_int(li_gc_threads());
+    li_parse_args(args, "i", &n);
+    if (n < 1)
+        li_error_fmt("not a valid number of threads: ~a", li_car(args));
+    li_gc_set_threads(n);
+    return li_void;
+}
+
+/*
+ * (gc-collect)
+ * Runs a full collection before evaluating anything else.
+ */
+static li_object *p_gc_collect(li_object *args)
+{
+    li_parse_args(args, "");
+    _gc.requested = LI_TRUE;
+    return li_void;
+}
+
+/*
+ * (with-region thunk)
+ * Calls thunk inside a region and returns what it returns.  The objects it
+ * allocated which did not escape are freed as soon as it returns, unless it
+ * runs inside another with-region, in which case they are only freed when the
+ * outermost one returns.
+ */
+static li_object *p_with_region(li_object *args)
+{
+    li_object *thunk, *res;
+    int sp;
+    li_parse_args(args, "o", &thunk);
+    li_assert_procedure(thunk);
+    li_region_begin();
+    res = li_apply(thunk, NULL);
+    sp = li_gc_push_root(&res);
+    li_region_end();
+    li_gc_pop_roots(sp);
+    return res;
+}
+
+static li_object *li_gc_num(size_t x)
+{
+    return (li_object *)li_num_with_rat(li_rat_with_nat(li_nat_with_int(x)));
+}
+
+static li_object *li_gc_stat(const char *name, li_object *val, li_object *tail)
+{
+    return li_cons(li_cons((li_object *)li_symbol(name), val), tail);
+}
+
+/*
+ * (gc-stats)
+ * Returns an association list of the collector's counters: allocations and
+ * allocated-bytes since startup, heap-bytes, minor-collections,
+ * major-collections, pause-total-us, pause-max-us, pauses, a vector of how
+ * many pauses took under 2, 4, 8... microseconds, and types, a list of
+ * (name count bytes) for the objects of each type on the heap.
+ */
+static li_object *p_gc_stats(li_object *args)
+{
+    li_gc_stats_t stats;
+    li_object *types = NULL, *pauses = NULL, *res;
+    size_t i;
+    li_parse_args(args, "");
+    li_gc_stats(&stats);
+    for (i = stats.num_types; i-- > 0; ) {
+        li_gc_type_stats_t *type = &stats.types[i];
+        types = li_cons(li_cons((li_object *)li_symbol(type->type->name),
+                    li_cons(li_gc_num(type->count),
+                        li_cons(li_gc_num(type->bytes), NULL))),
+                types);
+    }
+    free(stats.types);
+    for (i = LI_GC_PAUSE_BUCKETS; i-- > 0; )
+        pauses = li_cons(li_gc_num(stats.pauses[i]), pauses);
+    res = li_gc_stat("types", types, NULL);
+    res = li_gc_stat("pauses", li_vector(pauses), res);
+    res = li_gc_stat("pause-max-us", li_gc_num(stats.pause_max_us), res);
+    res = li_gc_stat("pause-total-us", li_gc_num(stats.pause_total_us), res);
+    res = li_gc_stat("major-collections", li_gc_num(stats.major_collections),
+            res);
+    res = li_gc_stat("minor-collections", li_gc_num(stats.minor_collections),
+            res);
+    res = li_gc_stat("heap-bytes", li_gc_num(stats.heap_bytes), res);
+    res = li_gc_stat("allocated-bytes", li_gc_num(stats.allocated_bytes), res);
+    return li_gc_stat("allocations", li_gc_num(stats.allocations), res);
+}
+
+extern void li_define_gc_functions(li_env_t *env)
+{
+    lilib_defproc(env, "gc-collect", p_gc_collect);
+    lilib_defproc(env, "gc-pause-budget-us", p_gc_pause_budget_us);
+    lilib_defproc(env, "gc-stats", p_gc_stats);
+    lilib_defproc(env, "gc-threads", p_gc_threads);
+    lilib_defproc(env, "with-region", p_with_region);
+}
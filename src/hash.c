@@ -0,0 +1,745 @@
+#include "li.h"
+#include "li_lib.h"
+#include "li_num.h"
+
+#include <string.h>
+
+/* How many slots a hash table starts out with, a power of two. */
+#define LI_HASH_TABLE_SIZE 8
+
+/* How many slots of the old array each update moves over while resizing. */
+#define LI_HASH_TABLE_MIGRATE 8
+
+/* How many parts of a structure equal-hash looks at, at most. */
+#define LI_EQUAL_HASH_BUDGET 64
+
+/* Marks an entry of the old array which was moved over or deleted. */
+#define LI_HASH_DELETED (1u << 31)
+
+/*
+ * Hash tables use open addressing with Robin Hood linear probing: an entry
+ * being inserted takes the slot of any entry it finds closer to its home
+ * slot than itself, and deleting one shifts the entries after it back.  So
+ * probe sequences stay short even when the table is fairly full, and a
+ * lookup stops as soon as it reaches an entry closer to its home than the
+ * key would be.  Each entry keeps its hash, which saves calling the
+ * equivalence predicate on most mismatches and rehashing when resizing.
+ *
+ * Rather than moving every entry at once, growing the table starts a new
+ * array twice the size and leaves the old one in place.  Every update then
+ * moves LI_HASH_TABLE_MIGRATE slots of the old array over, long before the
+ * new one could fill up, so no single insert pauses for long.  Until then,
+ * lookups try the new array and then the old one.  Entries taken out of the
+ * old array are marked deleted rather than shifted, so the part not yet
+ * moved over stays where it is.
+ *
+ * The equivalence predicates eq?, eqv?, equal? and string=? and the hash
+ * functions below are recognized and run natively; other procedures are
+ * called through the evaluator.
+ */
+
+typedef unsigned long li_hash_f(li_object *obj);
+typedef li_bool_t li_equiv_f(li_object *obj1, li_object *obj2);
+
+typedef struct {
+    li_object *key;
+    li_object *value;
+    unsigned int hash;
+    unsigned int dist;  /* 0 if the slot is empty, else 1 + its probe length */
+} li_hash_entry_t;
+
+struct li_hash_table_t {
+    LI_OBJ_HEAD;
+    li_object *equiv;
+    li_object *hash;
+    li_equiv_f *equiv_f;    /* NULL if equiv has to be called */
+    li_hash_f *hash_f;      /* NULL if hash has to be called */
+    li_hash_entry_t *entries;
+    size_t cap;
+    size_t count;           /* in both arrays */
+    li_hash_entry_t *old;   /* being moved over, if the table is resizing */
+    size_t old_cap;
+    size_t moved;
+    unsigned long stamp;    /* changes whenever entries move */
+};
+
+static li_bool_t eq_equiv(li_object *obj1, li_object *obj2)
+{
+    return li_is_eq(obj1, obj2);
+}
+
+/* Keys are checked here too, since a table can pair string=? with any hash. */
+static li_bool_t string_equiv(li_object *obj1, li_object *obj2)
+{
+    li_assert_string(obj1);
+    li_assert_string(obj2);
+    return li_string_cmp((li_str_t *)obj1, (li_str_t *)obj2) == LI_CMP_EQ;
+}
+
+extern unsigned long li_eq_hash(li_object *obj)
+{
+    return li_hash_bytes(&obj, sizeof(obj));
+}
+
+/*
+ * Objects of any other type with a comparison of its own hash by type alone,
+ * which is all eqv? promises about them.
+ */
+extern unsigned long li_eqv_hash(li_object *obj)
+{
+    const li_type_t *type;
+    if (li_is_number(obj))
+        return li_num_hash((li_num_t *)obj);
+    if (li_is_string(obj))
+        return li_string_hash((li_str_t *)obj);
+    if (!obj || li_is_immediate(obj) || !li_type(obj)->compare)
+        return li_eq_hash(obj);
+    type = li_type(obj);
+    return li_hash_bytes(&type, sizeof(type));
+}
+
+static unsigned long hash_combine(unsigned long h, unsigned long x)
+{
+    return (h ^ x) * 1099511628211ul + (h >> 7);
+}
+
+/*
+ * Hashes obj and its parts, following pairs along their cdrs, until the
+ * budget runs out, so it finishes even on circular structures.
+ */
+static unsigned long equal_hash(li_object *obj, int *budget)
+{
+    unsigned long h = 0;
+    int i, n;
+    while (li_is_pair(obj) && (*budget)-- > 0) {
+        h = hash_combine(h, equal_hash(li_car(obj), budget));
+        obj = li_cdr(obj);
+    }
+    if (li_is_pair(obj))
+        return h;
+    if (obj && !li_is_immediate(obj) && !li_is_string(obj)
+            && li_type(obj)->length && li_type(obj)->ref) {
+        n = li_type(obj)->length(obj);
+        h = hash_combine(h, n);
+        for (i = 0; i < n && (*budget)-- > 0; i++)
+            h = hash_combine(h, equal_hash(li_type(obj)->ref(obj, i), budget));
+        return h;
+    }
+    return hash_combine(h, li_eqv_hash(obj));
+}
+
+extern unsigned long li_equal_hash(li_object *obj)
+{
+    int budget = LI_EQUAL_HASH_BUDGET;
+    return equal_hash(obj, &budget);
+}
+
+static unsigned long string_hash(li_object *obj)
+{
+    li_assert_string(obj);
+    return li_string_hash((li_str_t *)obj);
+}
+
+static li_bool_t equal_equiv(li_object *obj1, li_object *obj2)
+{
+    return li_is_equal(obj1, obj2);
+}
+
+static li_bool_t eqv_equiv(li_object *obj1, li_object *obj2)
+{
+    return li_is_eqv(obj1, obj2);
+}
+
+/*
+ * The predicates and hash functions run natively, looked up by name once
+ * they are defined.  The first one is the default.
+ */
+static struct {
+    const char *name;
+    li_equiv_f *equiv_f;
+    const char *hash_name;
+    li_hash_f *hash_f;
+    li_object *equiv;
+    li_object *hash;
+} _kinds[] = {
+    { "equal?",     equal_equiv,  "equal-hash",       li_equal_hash, NULL, NULL },
+    { "eqv?",       eqv_equiv,    "eqv-hash",         li_eqv_hash,   NULL, NULL },
+    { "eq?",        eq_equiv,     "hash-by-identity", li_eq_hash,    NULL, NULL },
+    { "string=?",   string_equiv, "string-hash",      string_hash,   NULL, NULL },
+};
+
+#define LI_HASH_KINDS   (sizeof(_kinds) / sizeof(*_kinds))
+
+static void hash_table_mark(li_hash_table_t *table)
+{
+    size_t i;
+    li_mark(table->equiv);
+    li_mark(table->hash);
+    for (i = 0; i < table->cap; i++) {
+        if (table->entries[i].dist) {
+            li_mark(table->entries[i].key);
+            li_mark(table->entries[i].value);
+        }
+    }
+    for (i = table->moved; i < table->old_cap; i++) {
+        if (table->old[i].dist && !(table->old[i].dist & LI_HASH_DELETED)) {
+            li_mark(table->old[i].key);
+            li_mark(table->old[i].value);
+        }
+    }
+}
+
+static void hash_table_deinit(li_hash_table_t *table)
+{
+    free(table->entries);
+    free(table->old);
+}
+
+static void hash_table_write(li_hash_table_t *table, li_port_t *port)
+{
+    li_port_printf(port, "#[hash-table %lu]", (unsigned long)table->count);
+}
+
+const li_type_t li_type_hash_table = {
+    .name = "hash-table",
+    .size = sizeof(li_hash_table_t),
+    .mark = (li_mark_f *)hash_table_mark,
+    .deinit = (li_deinit_f *)hash_table_deinit,
+    .write = (li_write_f *)hash_table_write,
+};
+
+static unsigned int hash_table_hash(li_hash_table_t *table, li_object *key)
+{
+    li_object *h;
+    li_int_t x;
+    if (table->hash_f)
+        return (unsigned int)table->hash_f(key);
+    h = li_apply(table->hash, li_cons(key, NULL));
+    li_assert_integer(h);
+    x = li_to_integer(h);
+    return (unsigned int)li_hash_bytes(&x, sizeof(x));
+}
+
+static li_bool_t hash_table_equiv(li_hash_table_t *table, li_object *key1,
+        li_object *key2)
+{
+    if (table->equiv_f)
+        return table->equiv_f(key1, key2);
+    return !li_not(li_apply(table->equiv,
+                li_cons(key1, li_cons(key2, NULL))));
+}
+
+/*
+ * Returns the entry of entries holding key, or NULL.  A predicate called
+ * through the evaluator could change the table, in which case *stamp no
+ * longer matches and the lookup has to start over.
+ */
+static li_hash_entry_t *hash_table_probe(li_hash_table_t *table,
+        li_hash_entry_t *entries, size_t cap, li_object *key,
+        unsigned int hash, unsigned long *stamp)
+{
+    size_t mask = cap - 1, i;
+    unsigned int dist;
+    for (i = hash & mask, dist = 1; ; i = (i + 1) & mask, dist++) {
+        li_hash_entry_t *e = &entries[i];
+        if ((e->dist & ~LI_HASH_DELETED) < dist)
+            return NULL;
+        if (e->hash != hash || (e->dist & LI_HASH_DELETED))
+            continue;
+        if (hash_table_equiv(table, e->key, key) && table->stamp == *stamp)
+            return e;
+        if (table->stamp != *stamp)
+            return NULL;
+    }
+}
+
+static li_hash_entry_t *hash_table_find(li_hash_table_t *table,
+        li_object *key, unsigned int hash)
+{
+    li_hash_entry_t *e;
+    unsigned long stamp;
+    do {
+        stamp = table->stamp;
+        e = hash_table_probe(table, table->entries, table->cap, key, hash,
+                &stamp);
+        if (!e && table->old && stamp == table->stamp)
+            e = hash_table_probe(table, table->old, table->old_cap, key,
+                    hash, &stamp);
+    } while (stamp != table->stamp);
+    return e;
+}
+
+/* Inserts an entry known not to be in the table yet into the new array. */
+static void hash_table_insert(li_hash_table_t *table, li_hash_entry_t entry)
+{
+    size_t mask = table->cap - 1, i;
+    entry.dist = 1;
+    for (i = entry.hash & mask; ; i = (i + 1) & mask, entry.dist++) {
+        li_hash_entry_t *e = &table->entries[i];
+        if (!e->dist) {
+            *e = entry;
+            return;
+        }
+        if (e->dist < entry.dist) {
+            li_hash_entry_t tmp = *e;
+            *e = entry;
+            entry = tmp;
+        }
+    }
+}
+
+static void hash_table_migrate(li_hash_table_t *table, size_t n)
+{
+    for (; n && table->moved < table->old_cap; n--, table->moved++) {
+        li_hash_entry_t *e = &table->old[table->moved];
+        if (e->dist && !(e->dist & LI_HASH_DELETED)) {
+            hash_table_insert(table, *e);
+            e->key = e->value = NULL;
+            e->dist |= LI_HASH_DELETED;
+        }
+    }
+    if (table->moved == table->old_cap) {
+        free(table->old);
+        table->old = NULL;
+        table->old_cap = table->moved = 0;
+    }
+    table->stamp++;
+}
+
+static void hash_table_grow(li_hash_table_t *table)
+{
+    if (table->old)
+        hash_table_migrate(table, table->old_cap);
+    table->old = table->entries;
+    table->old_cap = table->cap;
+    table->moved = 0;
+    table->cap *= 2;
+    table->entries = li_allocate(NULL, table->cap, sizeof(*table->entries));
+    table->stamp++;
+}
+
+/* Takes e, which is in the table, out of it. */
+static void hash_table_remove(li_hash_table_t *table, li_hash_entry_t *e)
+{
+    size_t mask = table->cap - 1, i, j;
+    li_gc_write_barrier((li_object *)table, e->key);
+    li_gc_write_barrier((li_object *)table, e->value);
+    table->count--;
+    table->stamp++;
+    if (e < table->entries || e >= table->entries + table->cap) {
+        e->key = e->value = NULL;
+        e->dist |= LI_HASH_DELETED;
+        return;
+    }
+    for (i = e - table->entries, j = (i + 1) & mask;
+            table->entries[j].dist > 1; i = j, j = (j + 1) & mask) {
+        table->entries[i] = table->entries[j];
+        table->entries[i].dist--;
+    }
+    table->entries[i].key = table->entries[i].value = NULL;
+    table->entries[i].dist = 0;
+}
+
+extern li_hash_table_t *li_hash_table_make(li_object *equiv, li_object *hash)
+{
+    li_hash_table_t *table;
+    size_t i;
+    table = (li_hash_table_t *)li_create(&li_type_hash_table);
+    table->equiv = equiv ? equiv : _kinds[0].equiv;
+    table->hash = hash;
+    for (i = 0; i < LI_HASH_KINDS; i++) {
+        if (table->equiv == _kinds[i].equiv) {
+            table->equiv_f = _kinds[i].equiv_f;
+            if (!table->hash)
+                table->hash = _kinds[i].hash;
+        }
+    }
+    if (!table->hash)
+        table->hash = _kinds[0].hash;
+    for (i = 0; i < LI_HASH_KINDS; i++)
+        if (table->hash == _kinds[i].hash)
+            table->hash_f = _kinds[i].hash_f;
+    table->cap = LI_HASH_TABLE_SIZE;
+    table->entries = li_allocate(NULL, table->cap, sizeof(*table->entries));
+    return table;
+}
+
+extern li_object *li_hash_table_ref(li_hash_table_t *table, li_object *key,
+        li_object *def)
+{
+    li_hash_entry_t *e = hash_table_find(table, key,
+            hash_table_hash(table, key));
+    return e ? e->value : def;
+}
+
+extern li_bool_t li_hash_table_contains(li_hash_table_t *table,
+        li_object *key)
+{
+    return hash_table_find(table, key, hash_table_hash(table, key)) != NULL;
+}
+
+extern void li_hash_table_set(li_hash_table_t *table, li_object *key,
+        li_object *value)
+{
+    unsigned int hash = hash_table_hash(table, key);
+    li_hash_entry_t *e, entry;
+    if ((e = hash_table_find(table, key, hash))) {
+        li_gc_write_barrier((li_object *)table, e->value);
+        e->value = value;
+        return;
+    }
+    li_gc_write_barrier((li_object *)table, NULL);
+    if (4 * (table->count + 1) > 3 * table->cap)
+        hash_table_grow(table);
+    entry.key = key;
+    entry.value = value;
+    entry.hash = hash;
+    hash_table_insert(table, entry);
+    table->count++;
+    if (table->old)
+        hash_table_migrate(table, LI_HASH_TABLE_MIGRATE);
+    table->stamp++;
+}
+
+extern li_bool_t li_hash_table_delete(li_hash_table_t *table, li_object *key)
+{
+    li_hash_entry_t *e = hash_table_find(table, key,
+            hash_table_hash(table, key));
+    if (!e)
+        return LI_FALSE;
+    hash_table_remove(table, e);
+    if (table->old)
+        hash_table_migrate(table, LI_HASH_TABLE_MIGRATE);
+    return LI_TRUE;
+}
+
+extern size_t li_hash_table_size(li_hash_table_t *table)
+{
+    return table->count;
+}
+
+/* Calls fn on every entry of table, which fn must not change. */
+static void hash_table_each(li_hash_table_t *table,
+        void (*fn)(li_hash_entry_t *, void *), void *data)
+{
+    size_t i;
+    for (i = 0; i < table->cap; i++)
+        if (table->entries[i].dist)
+            fn(&table->entries[i], data);
+    for (i = table->moved; i < table->old_cap; i++)
+        if (table->old[i].dist && !(table->old[i].dist & LI_HASH_DELETED))
+            fn(&table->old[i], data);
+}
+
+static void cons_key(li_hash_entry_t *e, void *data)
+{
+    *(li_object **)data = li_cons(e->key, *(li_object **)data);
+}
+
+static void cons_value(li_hash_entry_t *e, void *data)
+{
+    *(li_object **)data = li_cons(e->value, *(li_object **)data);
+}
+
+static void cons_entry(li_hash_entry_t *e, void *data)
+{
+    *(li_object **)data = li_cons(li_cons(e->key, e->value),
+            *(li_object **)data);
+}
+
+/* Lets the marker know the entry is about to disappear. */
+static void barrier_entry(li_hash_entry_t *e, void *table)
+{
+    li_gc_write_barrier((li_object *)table, e->key);
+    li_gc_write_barrier((li_object *)table, e->value);
+}
+
+static li_object *hash_table_collect(li_hash_table_t *table,
+        void (*fn)(li_hash_entry_t *, void *))
+{
+    li_object *lst = NULL;
+    hash_table_each(table, fn, &lst);
+    return lst;
+}
+
+static li_hash_table_t *hash_table_copy(li_hash_table_t *table)
+{
+    li_hash_table_t *copy;
+    copy = (li_hash_table_t *)li_create(&li_type_hash_table);
+    *copy = *table;
+    copy->entries = li_allocate(NULL, table->cap, sizeof(*table->entries));
+    memcpy(copy->entries, table->entries, table->cap * sizeof(*table->entries));
+    if (table->old) {
+        copy->old = li_allocate(NULL, table->old_cap, sizeof(*table->old));
+        memcpy(copy->old, table->old, table->old_cap * sizeof(*table->old));
+    }
+    copy->stamp = 0;
+    return copy;
+}
+
+#define li_assert_hash_table(arg)   li_assert_type(hash_table, arg)
+
+/*
+ * (make-hash-table)
+ * (make-hash-table equiv)
+ * (make-hash-table equiv hash)
+ * Returns a new hash table comparing keys with equiv, equal? unless given.
+ * hash defaults to the hash function matching equiv, or equal-hash for a
+ * predicate other than eq?, eqv?, equal? and string=?.  As in SRFI 69.
+ */
+static li_object *p_make_hash_table(li_object *args)
+{
+    li_object *equiv = NULL, *hash = NULL;
+    li_parse_args(args, "?oo", &equiv, &hash);
+    if (equiv)
+        li_assert_procedure(equiv);
+    if (hash)
+        li_assert_procedure(hash);
+    return (li_object *)li_hash_table_make(equiv, hash);
+}
+
+static li_object *p_is_hash_table(li_object *args)
+{
+    li_object *obj;
+    li_parse_args(args, "o", &obj);
+    return li_boolean(li_is_hash_table(obj));
+}
+
+/*
+ * (hash-table-ref table key)
+ * (hash-table-ref table key failure)
+ * (hash-table-ref table key failure success)
+ * Calls success, if given, on the value key maps to in table, or returns it.
+ * If there is none, returns what failure returns when called without
+ * arguments, or signals an error if no failure was given.
+ */
+static li_object *p_hash_table_ref(li_object *args)
+{
+    li_object *obj, *key, *failure = NULL, *success = NULL;
+    li_hash_table_t *table;
+    li_hash_entry_t *e;
+    li_parse_args(args, "oo?oo", &obj, &key, &failure, &success);
+    li_assert_hash_table(obj);
+    table = (li_hash_table_t *)obj;
+    if (!(e = hash_table_find(table, key, hash_table_hash(table, key)))) {
+        if (!failure)
+            li_error_fmt("key not found: ~s", key);
+        return li_apply(failure, NULL);
+    }
+    if (success)
+        return li_apply(success, li_cons(e->value, NULL));
+    return e->value;
+}
+
+/*
+ * (hash-table-ref/default table key default)
+ * Returns the value key maps to in table, or default if there is none.
+ */
+static li_object *p_hash_table_ref_default(li_object *args)
+{
+    li_object *table, *key, *def;
+    li_parse_args(args, "ooo", &table, &key, &def);
+    li_assert_hash_table(table);
+    return li_hash_table_ref((li_hash_table_t *)table, key, def);
+}
+
+/*
+ * (hash-table-set! table key value ...)
+ * Maps each key to the value after it in table.
+ */
+static li_object *p_hash_table_set(li_object *args)
+{
+    li_object *table, *key, *value;
+    li_parse_args(args, "o.", &table, &args);
+    li_assert_hash_table(table);
+    while (args) {
+        li_parse_args(args, "oo.", &key, &value, &args);
+        li_hash_table_set((li_hash_table_t *)table, key, value);
+    }
+    return li_void;
+}
+
+/*
+ * (hash-table-delete! table key ...)
+ * Removes the keys from table and returns how many of them it held.
+ */
+static li_object *p_hash_table_delete(li_object *args)
+{
+    li_object *table, *key;
+    int n = 0;
+    li_parse_args(args, "o.", &table, &args);
+    li_assert_hash_table(table);
+    while (args) {
+        li_parse_args(args, "o.", &key, &args);
+        n += li_hash_table_delete((li_hash_table_t *)table, key);
+    }
+    return (li_object *)li_num_with_int(n);
+}
+
+static li_object *p_hash_table_contains(li_object *args)
+{
+    li_object *table, *key;
+    li_parse_args(args, "oo", &table, &key);
+    li_assert_hash_table(table);
+    return li_boolean(li_hash_table_contains((li_hash_table_t *)table, key));
+}
+
+static li_object *p_hash_table_size(li_object *args)
+{
+    li_object *table;
+    li_parse_args(args, "o", &table);
+    li_assert_hash_table(table);
+    return (li_object *)li_num_with_long(
+            li_hash_table_size((li_hash_table_t *)table));
+}
+
+static li_object *p_hash_table_keys(li_object *args)
+{
+    li_object *table;
+    li_parse_args(args, "o", &table);
+    li_assert_hash_table(table);
+    return hash_table_collect((li_hash_table_t *)table, cons_key);
+}
+
+static li_object *p_hash_table_values(li_object *args)
+{
+    li_object *table;
+    li_parse_args(args, "o", &table);
+    li_assert_hash_table(table);
+    return hash_table_collect((li_hash_table_t *)table, cons_value);
+}
+
+/*
+ * (hash-table->alist table)
+ * Returns a list of (key . value) pairs, one for each entry of table.
+ */
+static li_object *p_hash_table_to_alist(li_object *args)
+{
+    li_object *table;
+    li_parse_args(args, "o", &table);
+    li_assert_hash_table(table);
+    return hash_table_collect((li_hash_table_t *)table, cons_entry);
+}
+
+/*
+ * (hash-table-copy table)
+ * Returns a new hash table with the same entries, equivalence predicate and
+ * hash function as table.  There are no immutable tables, so unlike SRFI 69
+ * this takes no mutable argument.
+ */
+static li_object *p_hash_table_copy(li_object *args)
+{
+    li_object *table;
+    li_parse_args(args, "o", &table);
+    li_assert_hash_table(table);
+    return (li_object *)hash_table_copy((li_hash_table_t *)table);
+}
+
+static li_object *p_hash_table_clear(li_object *args)
+{
+    li_object *obj;
+    li_hash_table_t *table;
+    li_parse_args(args, "o", &obj);
+    li_assert_hash_table(obj);
+    table = (li_hash_table_t *)obj;
+    hash_table_each(table, barrier_entry, table);
+    free(table->entries);
+    free(table->old);
+    table->old = NULL;
+    table->old_cap = table->moved = 0;
+    table->cap = LI_HASH_TABLE_SIZE;
+    table->entries = li_allocate(NULL, table->cap, sizeof(*table->entries));
+    table->count = 0;
+    table->stamp++;
+    return li_void;
+}
+
+static li_object *p_hash_table_equivalence_function(li_object *args)
+{
+    li_object *table;
+    li_parse_args(args, "o", &table);
+    li_assert_hash_table(table);
+    return ((li_hash_table_t *)table)->equiv;
+}
+
+static li_object *p_hash_table_hash_function(li_object *args)
+{
+    li_object *table;
+    li_parse_args(args, "o", &table);
+    li_assert_hash_table(table);
+    return ((li_hash_table_t *)table)->hash;
+}
+
+/* Turns a hash into a non-negative fixnum, or one below bound if given. */
+static li_object *hash_result(unsigned long hash, li_object *args)
+{
+    li_object *obj;
+    li_int_t bound = 0;
+    li_parse_args(args, "o?I", &obj, &bound);
+    hash >>= 2;
+    if (bound > 0)
+        hash %= (unsigned long)bound;
+    return (li_object *)li_num_with_long((long)hash);
+}
+
+/*
+ * (equal-hash obj)
+ * (equal-hash obj bound)
+ * Returns a hash of obj, the same for objects which are equal?, below bound
+ * if given.  Looks at no more than the first few parts of a structure.
+ */
+static li_object *p_equal_hash(li_object *args)
+{
+    li_assert_pair(args);
+    return hash_result(li_equal_hash(li_car(args)), args);
+}
+
+static li_object *p_eqv_hash(li_object *args)
+{
+    li_assert_pair(args);
+    return hash_result(li_eqv_hash(li_car(args)), args);
+}
+
+static li_object *p_hash_by_identity(li_object *args)
+{
+    li_assert_pair(args);
+    return hash_result(li_eq_hash(li_car(args)), args);
+}
+
+static li_object *p_string_hash(li_object *args)
+{
+    li_assert_pair(args);
+    return hash_result(string_hash(li_car(args)), args);
+}
+
+extern void li_define_hash_functions(li_env_t *env)
+{
+    size_t i;
+    lilib_defproc(env, "make-hash-table", p_make_hash_table);
+    lilib_defproc(env, "hash-table?", p_is_hash_table);
+    lilib_defproc(env, "hash-table-ref", p_hash_table_ref);
+    lilib_defproc(env, "hash-table-ref/default", p_hash_table_ref_default);
+    lilib_defproc(env, "hash-table-set!", p_hash_table_set);
+    lilib_defproc(env, "hash-table-delete!", p_hash_table_delete);
+    lilib_defproc(env, "hash-table-contains?", p_hash_table_contains);
+    lilib_defproc(env, "hash-table-size", p_hash_table_size);
+    lilib_defproc(env, "hash-table-keys", p_hash_table_keys);
+    lilib_defproc(env, "hash-table-values", p_hash_table_values);
+    lilib_defproc(env, "hash-table->alist", p_hash_table_to_alist);
+    lilib_defproc(env, "hash-table-copy", p_hash_table_copy);
+    lilib_defproc(env, "hash-table-clear!", p_hash_table_clear);
+    lilib_defproc(env, "hash-table-equivalence-function",
+            p_hash_table_equivalence_function);
+    lilib_defproc(env, "hash-table-hash-function",
+            p_hash_table_hash_function);
+    lilib_defproc(env, "equal-hash", p_equal_hash);
+    lilib_defproc(env, "eqv-hash", p_eqv_hash);
+    lilib_defproc(env, "hash-by-identity", p_hash_by_identity);
+    lilib_defproc(env, "string-hash", p_string_hash);
+    for (i = 0; i < LI_HASH_KINDS; i++) {
+        _kinds[i].equiv = li_env_lookup(env, li_symbol(_kinds[i].name));
+        _kinds[i].hash = li_env_lookup(env, li_symbol(_kinds[i].hash_name));
+        li_gc_protect(_kinds[i].equiv);
+        li_gc_protect(_kinds[i].hash);
+    }
+}
@@ -1,4 +1,5 @@
 #include "li.h"
+#include "li_gc.h"
 
 #include <dlfcn.h> /* dlopen dlsym etc */
 #include <limits.h> /* PATH_MAX */
@@ -13,18 +14,17 @@ typedef struct {
 static void dl_deinit(li_dl_t *dl)
 {
     dlclose(dl->handle);
-    free(dl);
 }
 
-static const li_type_t li_type_dl = {
+const li_type_t li_type_dl = {
     .name = "dl",
+    .size = sizeof(li_dl_t),
     .deinit = (li_deinit_f *)dl_deinit,
 };
 
 static li_dl_t *li_dl(void *handle)
 {
-    li_dl_t *dl = li_allocate(NULL, 1, sizeof(*dl));
-    li_object_init((li_object *)dl, &li_type_dl);
+    li_dl_t *dl = (li_dl_t *)li_create(&li_type_dl);
     dl->handle = handle;
     return dl;
 }
@@ -81,7 +81,7 @@ extern void li_import(li_object *set, li_env_t *env)
             if (li_is_symbol(obj))
                 n += snprintf(path + n, PATH_MAX - n, "/%s", li_to_symbol(obj));
             else if (li_is_integer(obj))
-                n += snprintf(path + n, PATH_MAX - n, "/%d", li_to_integer(obj));
+                n += snprintf(path + n, PATH_MAX - n, "/%ld", li_to_integer(obj));
             else
                 goto error;
             iter = li_cdr(iter);
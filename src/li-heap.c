@@ -0,0 +1,563 @@
+/*
+ * Reads a heap dump written by (heap-dump filename) and reports which objects,
+ * types and source locations keep the most memory alive.
+ *
+ * An object's retained size is the number of bytes which would be freed along
+ * with it, that is its own size plus that of every object it dominates: those
+ * which can only be reached from the roots through it.  The dominator tree is
+ * computed with the algorithm of Cooper, Harvey and Kennedy, "A Simple, Fast
+ * Dominance Algorithm".
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define LI_DUMP_MAGIC "LIHEAP1\n"
+
+#define NONE ((size_t)-1)
+
+typedef struct {
+    size_t addr;
+    size_t type;
+    size_t size;
+    size_t file;
+    size_t line;
+    size_t site;        /* index into sites, or NONE */
+    size_t first;       /* first reference in refs */
+    size_t count;       /* number of references */
+} object_t;
+
+typedef struct {
+    size_t file;
+    size_t line;
+} site_t;
+
+typedef struct {
+    size_t key;
+    size_t count;       /* objects of this type or site */
+    size_t retained;
+} total_t;
+
+static const char *progname = "li-heap";
+static const char *filename;
+
+static struct {
+    char **names;       /* names[id - 1] */
+    size_t num_names;
+    object_t *objs;     /* objs[0] is a virtual root referring to the roots */
+    size_t num_objs;
+    size_t *refs;       /* addresses, then object indices once resolved */
+    size_t num_refs;
+    size_t *roots;
+    size_t num_roots;
+    site_t *sites;
+    size_t num_sites;
+} heap;
+
+static size_t *retained;
+
+static void die(const char *msg)
+{
+    fprintf(stderr, "%s: %s: %s\n", progname, filename, msg);
+    exit(1);
+}
+
+static void *allocate(void *ptr, size_t count, size_t size)
+{
+    if (!count)
+        count = 1;
+    if (!(ptr = realloc(ptr, count * size))) {
+        fprintf(stderr, "%s: out of memory\n", progname);
+        exit(1);
+    }
+    return ptr;
+}
+
+/* Grows an array of *cap elements so that it holds at least size + 1. */
+static void *reserve(void *ptr, size_t size, size_t *cap, size_t elem)
+{
+    if (size < *cap)
+        return ptr;
+    *cap = *cap ? *cap * 2 : 64;
+    return allocate(ptr, *cap, elem);
+}
+
+/*
+ * Reading.
+ */
+
+static size_t read_num(FILE *fp)
+{
+    size_t x = 0;
+    int shift = 0, c;
+    do {
+        if ((c = getc(fp)) == EOF)
+            die("truncated dump");
+        x |= (size_t)(c & 0x7f) << shift;
+        shift += 7;
+    } while (c & 0x80);
+    return x;
+}
+
+static void read_name(FILE *fp, size_t *cap)
+{
+    size_t id = read_num(fp), len = read_num(fp);
+    char *name;
+    if (id != heap.num_names + 1)
+        die("names out of order");
+    name = allocate(NULL, len + 1, 1);
+    if (fread(name, 1, len, fp) != len)
+        die("truncated dump");
+    name[len] = '\0';
+    heap.names = reserve(heap.names, heap.num_names, cap, sizeof(*heap.names));
+    heap.names[heap.num_names++] = name;
+}
+
+static void read_dump(FILE *fp)
+{
+    size_t cap_names = 0, cap_objs = 0, cap_refs = 0, cap_roots = 0, i;
+    char magic[sizeof(LI_DUMP_MAGIC) - 1];
+    object_t *obj;
+    int tag;
+    if (fread(magic, 1, sizeof(magic), fp) != sizeof(magic)
+            || memcmp(magic, LI_DUMP_MAGIC, sizeof(magic)))
+        die("not a heap dump");
+    heap.objs = reserve(heap.objs, 0, &cap_objs, sizeof(*heap.objs));
+    memset(&heap.objs[0], 0, sizeof(heap.objs[0]));
+    heap.num_objs = 1;
+    while ((tag = getc(fp)) != 'E') {
+        switch (tag) {
+        case 'S':
+            read_name(fp, &cap_names);
+            break;
+        case 'O':
+            heap.objs = reserve(heap.objs, heap.num_objs, &cap_objs,
+                    sizeof(*heap.objs));
+            obj = &heap.objs[heap.num_objs++];
+            obj->addr = read_num(fp);
+            obj->type = read_num(fp);
+            obj->size = read_num(fp);
+            obj->file = read_num(fp);
+            obj->line = read_num(fp);
+            obj->site = NONE;
+            obj->first = heap.num_refs;
+            obj->count = read_num(fp);
+            if (obj->type < 1 || obj->type > heap.num_names
+                    || obj->file > heap.num_names)
+                die("unknown name");
+            for (i = 0; i < obj->count; i++) {
+                heap.refs = reserve(heap.refs, heap.num_refs, &cap_refs,
+                        sizeof(*heap.refs));
+                heap.refs[heap.num_refs++] = read_num(fp);
+            }
+            break;
+        case 'R':
+            heap.roots = reserve(heap.roots, heap.num_roots, &cap_roots,
+                    sizeof(*heap.roots));
+            heap.roots[heap.num_roots++] = read_num(fp);
+            break;
+        case EOF:
+            die("truncated dump");
+            break;
+        default:
+            die("unknown record");
+        }
+    }
+}
+
+/*
+ * The object graph.
+ */
+
+/* Maps addresses to object indices with open addressing. */
+static struct {
+    size_t *table;
+    size_t mask;
+} index_of;
+
+static size_t hash_addr(size_t addr)
+{
+    return (addr >> 3) * 2654435761u;
+}
+
+static void index_objects(void)
+{
+    size_t cap = 1, i, h;
+    while (cap < 2 * heap.num_objs)
+        cap *= 2;
+    index_of.table = allocate(NULL, cap, sizeof(*index_of.table));
+    index_of.mask = cap - 1;
+    for (i = 0; i < cap; i++)
+        index_of.table[i] = NONE;
+    for (i = 1; i < heap.num_objs; i++) {
+        h = hash_addr(heap.objs[i].addr) & index_of.mask;
+        while (index_of.table[h] != NONE)
+            h = (h + 1) & index_of.mask;
+        index_of.table[h] = i;
+    }
+}
+
+static size_t lookup(size_t addr)
+{
+    size_t h = hash_addr(addr) & index_of.mask, i;
+    while ((i = index_of.table[h]) != NONE) {
+        if (heap.objs[i].addr == addr)
+            return i;
+        h = (h + 1) & index_of.mask;
+    }
+    return NONE;
+}
+
+/*
+ * Replaces addresses with object indices, dropping references to objects
+ * which are not on the heap, and makes the virtual root refer to the roots.
+ */
+static void resolve_refs(void)
+{
+    size_t i, j, n, k, total = 0;
+    size_t *refs;
+    index_objects();
+    refs = allocate(NULL, heap.num_refs + heap.num_roots, sizeof(*refs));
+    for (j = 0; j < heap.num_roots; j++)
+        if ((k = lookup(heap.roots[j])) != NONE)
+            refs[total++] = k;
+    heap.objs[0].first = 0;
+    heap.objs[0].count = total;
+    for (i = 1; i < heap.num_objs; i++) {
+        object_t *obj = &heap.objs[i];
+        n = total;
+        for (j = 0; j < obj->count; j++)
+            if ((k = lookup(heap.refs[obj->first + j])) != NONE)
+                refs[total++] = k;
+        obj->first = n;
+        obj->count = total - n;
+    }
+    free(heap.refs);
+    heap.refs = refs;
+    heap.num_refs = total;
+}
+
+/* Gives every object read from a file the index of its file and line. */
+static void find_sites(void)
+{
+    size_t cap = 1, i, h, *table, mask, cap_sites = 0;
+    while (cap < 2 * heap.num_objs)
+        cap *= 2;
+    table = allocate(NULL, cap, sizeof(*table));
+    mask = cap - 1;
+    for (i = 0; i < cap; i++)
+        table[i] = NONE;
+    for (i = 1; i < heap.num_objs; i++) {
+        object_t *obj = &heap.objs[i];
+        if (!obj->file)
+            continue;
+        h = (obj->file * 31 + obj->line) * 2654435761u & mask;
+        while (table[h] != NONE && (heap.sites[table[h]].file != obj->file
+                    || heap.sites[table[h]].line != obj->line))
+            h = (h + 1) & mask;
+        if (table[h] == NONE) {
+            heap.sites = reserve(heap.sites, heap.num_sites, &cap_sites,
+                    sizeof(*heap.sites));
+            heap.sites[heap.num_sites].file = obj->file;
+            heap.sites[heap.num_sites].line = obj->line;
+            table[h] = heap.num_sites++;
+        }
+        obj->site = table[h];
+    }
+    free(table);
+}
+
+/*
+ * Dominators.
+ */
+
+/* Objects in depth first postorder from the virtual root, which comes last. */
+static size_t *postorder;
+static size_t num_reachable;
+static size_t *order;   /* position of each object in postorder, or NONE */
+static size_t *idom;
+
+static void depth_first(void)
+{
+    size_t *stack, *next, sp = 0, v, w;
+    postorder = allocate(NULL, heap.num_objs, sizeof(*postorder));
+    order = allocate(NULL, heap.num_objs, sizeof(*order));
+    stack = allocate(NULL, heap.num_objs, sizeof(*stack));
+    next = allocate(NULL, heap.num_objs, sizeof(*next));
+    for (v = 0; v < heap.num_objs; v++) {
+        order[v] = NONE;
+        next[v] = 0;
+    }
+    /* order[v] is 0 while v is on the stack, before it gets its position. */
+    order[0] = 0;
+    stack[sp++] = 0;
+    while (sp) {
+        v = stack[sp - 1];
+        if (next[v] < heap.objs[v].count) {
+            w = heap.refs[heap.objs[v].first + next[v]++];
+            if (order[w] == NONE) {
+                order[w] = 0;
+                stack[sp++] = w;
+            }
+        } else {
+            order[v] = num_reachable;
+            postorder[num_reachable++] = v;
+            sp--;
+        }
+    }
+    free(stack);
+    free(next);
+}
+
+static size_t intersect(size_t a, size_t b)
+{
+    while (a != b) {
+        while (order[a] < order[b])
+            a = idom[a];
+        while (order[b] < order[a])
+            b = idom[b];
+    }
+    return a;
+}
+
+static void dominators(void)
+{
+    size_t *preds, *first, i, j, v, w, d;
+    int changed = 1;
+
+    /* Predecessor lists of the reachable objects. */
+    first = allocate(NULL, heap.num_objs + 1, sizeof(*first));
+    memset(first, 0, (heap.num_objs + 1) * sizeof(*first));
+    for (v = 0; v < heap.num_objs; v++)
+        if (order[v] != NONE)
+            for (j = 0; j < heap.objs[v].count; j++)
+                first[heap.refs[heap.objs[v].first + j] + 1]++;
+    for (v = 0; v < heap.num_objs; v++)
+        first[v + 1] += first[v];
+    preds = allocate(NULL, first[heap.num_objs], sizeof(*preds));
+    for (v = 0; v < heap.num_objs; v++)
+        if (order[v] != NONE)
+            for (j = 0; j < heap.objs[v].count; j++)
+                preds[first[heap.refs[heap.objs[v].first + j]]++] = v;
+    for (v = heap.num_objs; v > 0; v--)
+        first[v] = first[v - 1];
+    first[0] = 0;
+
+    idom = allocate(NULL, heap.num_objs, sizeof(*idom));
+    for (v = 0; v < heap.num_objs; v++)
+        idom[v] = NONE;
+    idom[0] = 0;
+    while (changed) {
+        changed = 0;
+        /* Reverse postorder, skipping the virtual root. */
+        for (i = num_reachable - 1; i-- > 0; ) {
+            v = postorder[i];
+            d = NONE;
+            for (j = first[v]; j < first[v + 1]; j++) {
+                w = preds[j];
+                if (idom[w] == NONE)
+                    continue;
+                d = d == NONE ? w : intersect(w, d);
+            }
+            if (idom[v] != d) {
+                idom[v] = d;
+                changed = 1;
+            }
+        }
+    }
+    free(preds);
+    free(first);
+}
+
+static void retained_sizes(void)
+{
+    size_t i, v;
+    retained = allocate(NULL, heap.num_objs, sizeof(*retained));
+    for (v = 0; v < heap.num_objs; v++)
+        retained[v] = heap.objs[v].size;
+    /* Every object comes before its dominator in postorder. */
+    for (i = 0; i + 1 < num_reachable; i++) {
+        v = postorder[i];
+        retained[idom[v]] += retained[v];
+    }
+}
+
+/*
+ * Sums the retained sizes of the objects of each type, or each site, counting
+ * only the outermost ones so that nothing is counted twice: an object
+ * dominated by another of the same type is part of the latter's size already.
+ * The dominator tree is walked depth first, keeping track of how many objects
+ * of each key are on the path from the root.
+ */
+static total_t *totals(size_t num_keys, size_t (*key_of)(size_t))
+{
+    total_t *totals = allocate(NULL, num_keys, sizeof(*totals));
+    size_t *open = allocate(NULL, num_keys, sizeof(*open));
+    size_t *first = allocate(NULL, heap.num_objs + 1, sizeof(*first));
+    size_t *children, *stack, *next, sp = 0, i, v, w, k;
+    memset(first, 0, (heap.num_objs + 1) * sizeof(*first));
+    for (k = 0; k < num_keys; k++) {
+        totals[k].key = k;
+        totals[k].count = 0;
+        totals[k].retained = 0;
+        open[k] = 0;
+    }
+    for (i = 0; i + 1 < num_reachable; i++)
+        first[idom[postorder[i]] + 1]++;
+    for (v = 0; v < heap.num_objs; v++)
+        first[v + 1] += first[v];
+    children = allocate(NULL, num_reachable, sizeof(*children));
+    next = allocate(NULL, heap.num_objs, sizeof(*next));
+    memcpy(next, first, heap.num_objs * sizeof(*next));
+    for (i = 0; i + 1 < num_reachable; i++)
+        children[next[idom[postorder[i]]]++] = postorder[i];
+    memcpy(next, first, heap.num_objs * sizeof(*next));
+    stack = allocate(NULL, num_reachable, sizeof(*stack));
+    stack[sp++] = 0;
+    while (sp) {
+        v = stack[sp - 1];
+        if (next[v] < first[v + 1]) {
+            w = children[next[v]++];
+            if ((k = key_of(w)) != NONE) {
+                totals[k].count++;
+                if (!open[k]++)
+                    totals[k].retained += retained[w];
+            }
+            stack[sp++] = w;
+        } else {
+            if (v && (k = key_of(v)) != NONE)
+                open[k]--;
+            sp--;
+        }
+    }
+    free(open);
+    free(first);
+    free(children);
+    free(next);
+    free(stack);
+    return totals;
+}
+
+static size_t type_of(size_t v)
+{
+    return heap.objs[v].type - 1;
+}
+
+static size_t site_of(size_t v)
+{
+    return heap.objs[v].site;
+}
+
+/*
+ * Reporting.
+ */
+
+static int by_retained(const void *a, const void *b)
+{
+    size_t x = retained[*(const size_t *)a], y = retained[*(const size_t *)b];
+    return x < y ? 1 : x > y ? -1 : 0;
+}
+
+static int by_total(const void *a, const void *b)
+{
+    size_t x = ((const total_t *)a)->retained;
+    size_t y = ((const total_t *)b)->retained;
+    return x < y ? 1 : x > y ? -1 : 0;
+}
+
+static void print_site(size_t site)
+{
+    if (site == NONE)
+        return;
+    printf("  %s:%lu", heap.names[heap.sites[site].file - 1],
+            (unsigned long)heap.sites[site].line);
+}
+
+static void report(size_t top)
+{
+    size_t i, n, v, bytes = 0, garbage = 0;
+    size_t *objs;
+    total_t *types, *sites;
+
+    for (v = 1; v < heap.num_objs; v++) {
+        bytes += heap.objs[v].size;
+        if (order[v] == NONE)
+            garbage += heap.objs[v].size;
+    }
+    printf("%lu objects, %lu bytes, %lu bytes unreachable\n",
+            (unsigned long)(heap.num_objs - 1), (unsigned long)bytes,
+            (unsigned long)garbage);
+
+    types = totals(heap.num_names, type_of);
+    qsort(types, heap.num_names, sizeof(*types), by_total);
+    printf("\n%12s %10s  type\n", "retained", "count");
+    for (i = 0; i < heap.num_names && i < top && types[i].count; i++)
+        printf("%12lu %10lu  %s\n", (unsigned long)types[i].retained,
+                (unsigned long)types[i].count, heap.names[types[i].key]);
+    free(types);
+
+    if (heap.num_sites) {
+        sites = totals(heap.num_sites, site_of);
+        qsort(sites, heap.num_sites, sizeof(*sites), by_total);
+        printf("\n%12s %10s  site\n", "retained", "count");
+        for (i = 0; i < heap.num_sites && i < top; i++) {
+            printf("%12lu %10lu", (unsigned long)sites[i].retained,
+                    (unsigned long)sites[i].count);
+            print_site(sites[i].key);
+            putchar('\n');
+        }
+        free(sites);
+    }
+
+    n = num_reachable - 1;
+    objs = allocate(NULL, n, sizeof(*objs));
+    memcpy(objs, postorder, n * sizeof(*objs));
+    qsort(objs, n, sizeof(*objs), by_retained);
+    printf("\n%12s %10s  object\n", "retained", "size");
+    for (i = 0; i < n && i < top; i++) {
+        object_t *obj = &heap.objs[objs[i]];
+        printf("%12lu %10lu  %s %#lx", (unsigned long)retained[objs[i]],
+                (unsigned long)obj->size, heap.names[obj->type - 1],
+                (unsigned long)obj->addr);
+        print_site(obj->site);
+        putchar('\n');
+    }
+    free(objs);
+}
+
+static void usage(void)
+{
+    fprintf(stderr, "usage: %s [-n count] dump\n", progname);
+    exit(2);
+}
+
+int main(int argc, char *argv[])
+{
+    size_t top = 20;
+    FILE *fp;
+    int i = 1;
+    if (i + 1 < argc && !strcmp(argv[i], "-n")) {
+        char *end;
+        top = strtoul(argv[i + 1], &end, 10);
+        if (*end || !*argv[i + 1])
+            usage();
+        i += 2;
+    }
+    if (i + 1 != argc)
+        usage();
+    filename = argv[i];
+    if (!(fp = fopen(filename, "rb"))) {
+        perror(filename);
+        return 1;
+    }
+    read_dump(fp);
+    fclose(fp);
+    resolve_refs();
+    find_sites();
+    depth_first();
+    dominators();
+    retained_sizes();
+    report(top);
+    return 0;
+}
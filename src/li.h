@@ -1,6 +1,7 @@
 #ifndef _li_h
 #define _li_h
 
+#include <limits.h> /* LONG_MAX */
 #include <stdio.h>
 #include <stdlib.h>
 
@@ -32,27 +33,29 @@ typedef struct li_type_t li_type_t;
 typedef struct li_object li_object;
 
 #define LI_OBJ_HEAD \
-    const li_type_t *type; \
-    li_bool_t locked
+    const li_type_t *type
 
 struct li_object {
     LI_OBJ_HEAD;
 };
 
-typedef struct li_boolean_t li_boolean_t;
 typedef struct li_bytevector_t li_bytevector_t;
-typedef struct li_character_obj_t li_character_obj_t;
 typedef struct li_env_t li_env_t;
 typedef struct li_macro_t li_macro_t;
 typedef struct li_num_t li_num_t;
+typedef struct li_hash_table_t li_hash_table_t;
 typedef struct li_pair_t li_pair_t;
 typedef struct li_port_t li_port_t;
 typedef struct li_proc_obj_t li_proc_obj_t;
 typedef struct li_str_t li_str_t;
+typedef struct li_string_builder_t li_string_builder_t;
 typedef struct li_sym_t li_sym_t;
 typedef struct li_transformer_t li_transformer_t;
 typedef struct li_type_obj_t li_type_obj_t;
 typedef struct li_vector_t li_vector_t;
+typedef struct li_weak_box_t li_weak_box_t;
+typedef struct li_ephemeron_t li_ephemeron_t;
+typedef struct li_guardian_t li_guardian_t;
 
 extern void li_mark(li_object *obj);
 
@@ -78,14 +81,61 @@ struct li_type_t {
     li_object *(*proc)(li_object *);
 };
 
+/*
+ * Immediates are not allocated but kept in the object pointer itself, tagged
+ * by its lowest bits, at least one of the lowest two being set, which the
+ * address of a real object never has:
+ *
+ *     ...xxx1  a fixnum, an integer from LI_FIXNUM_MIN to LI_FIXNUM_MAX
+ *     ...0010  a character, its code point in the bits above the tag
+ *     ...0110  #f, or #t with the bit above the tag set
+ *        1010  void
+ *        1110  the eof object
+ *
+ * The empty list is NULL.  Immediates have no fields, so anything but li_type
+ * which looks inside an object must rule them out with li_is_immediate first.
+ */
+#define li_is_immediate(obj)            ((size_t)(obj) & 3)
+#define li_tag(obj)                     ((size_t)(obj) & 15)
+#define li_immediate(x, tag)            \
+    ((li_object *)(((size_t)(x) << 4) | (tag)))
+#define li_immediate_value(obj)         ((size_t)(obj) >> 4)
+
+#define LI_TAG_CHARACTER                2
+#define LI_TAG_BOOLEAN                  6
+#define LI_TAG_VOID                     10
+#define LI_TAG_EOF                      14
+
+#define LI_FIXNUM_MIN                   (LONG_MIN >> 1)
+#define LI_FIXNUM_MAX                   (LONG_MAX >> 1)
+#define li_is_fixnum(obj)               ((size_t)(obj) & 1)
+#define li_fixnum(x)                    \
+    ((li_object *)(((size_t)(long)(x) << 1) | 1))
+#define li_fixnum_value(obj)            ((long)(size_t)(obj) >> 1)
+
+/* The type of each immediate, indexed by li_tag. */
+extern const li_type_t *const li_tag_types[16];
+
 /* Type checking. */
-#define li_type(obj)                    ((obj) ? (obj)->type : &li_type_pair)
+#define li_type(obj)                    (li_is_immediate(obj) \
+    ? li_tag_types[li_tag(obj)] : (obj) ? (obj)->type : &li_type_pair)
 #define li_is_type(obj, type)           ((obj) && li_type(obj) == (type))
 
+/*
+ * The header of an object is a single word, its type, since the collector
+ * keeps its bits in the page (see alloc.c).  A type no immediate has is
+ * therefore checked for with a tag test and a compare against the header,
+ * without going through li_tag_types.
+ */
+#define li_is_object_type(obj, t)       \
+    ((obj) && !li_is_immediate(obj) && (obj)->type == (t))
+
 extern const li_type_t li_type_boolean;
 extern const li_type_t li_type_bytevector;
 extern const li_type_t li_type_character;
 extern const li_type_t li_type_environment;
+extern const li_type_t li_type_eof;
+extern const li_type_t li_type_hash_table;
 extern const li_type_t li_type_macro;
 extern const li_type_t li_type_number;
 extern const li_type_t li_type_pair;
@@ -93,9 +143,14 @@ extern const li_type_t li_type_port;
 extern const li_type_t li_type_procedure;
 extern const li_type_t li_type_special_form;
 extern const li_type_t li_type_string;
+extern const li_type_t li_type_string_builder;
 extern const li_type_t li_type_symbol;
 extern const li_type_t li_type_type;
 extern const li_type_t li_type_vector;
+extern const li_type_t li_type_void;
+extern const li_type_t li_type_weak_box;
+extern const li_type_t li_type_ephemeron;
+extern const li_type_t li_type_guardian;
 
 /* bytevectors */
 extern li_bytevector_t *li_bytevector(li_object *lst);
@@ -115,10 +170,8 @@ extern size_t li_chr_decode(li_character_t *chr, const char *s);
 extern size_t li_chr_encode(li_character_t chr, char *s, size_t n);
 extern size_t li_chr_count(const char *s);
 
-struct li_character_obj_t {
-    LI_OBJ_HEAD;
-    li_character_t character;
-};
+/* Hashes the n bytes at bytes.  Equal byte strings hash the same. */
+extern unsigned long li_hash_bytes(const void *bytes, size_t n);
 
 /* environment */
 
@@ -134,7 +187,10 @@ extern void li_setup_environment(li_env_t *env);
 extern void li_import(li_object *name, li_env_t *env);
 extern void li_include_shared(const char *name, li_env_t *env);
 
-/* Destroys all objects that cannot be reached from the given environment. */
+/*
+ * Destroys all objects that cannot be reached from the given environment or the
+ * root set.  If env is NULL, every object is destroyed.
+ */
 extern void li_cleanup(li_env_t *env);
 
 /* macros */
@@ -142,17 +198,22 @@ extern li_object *li_macro_expand(li_macro_t *mac, li_object *expr, li_env_t *en
 
 /* numbers */
 extern li_num_t *li_num_with_int(int x);
+extern li_num_t *li_num_with_long(long x);
 extern int li_num_to_int(li_num_t *x);
+extern long li_num_to_long(li_num_t *x);
+/* Whether li_num_to_long gives x itself rather than clamping it. */
+extern li_bool_t li_num_fits_long(li_num_t *x);
 extern li_bool_t li_num_is_integer(li_num_t *x);
 
+/* Hashes x by its value, consistently with li_num_cmp on exact numbers. */
+extern unsigned long li_num_hash(li_num_t *x);
+
 /* Pairs */
 
 struct li_pair_t {
     LI_OBJ_HEAD;
     li_object *car;
     li_object *cdr;
-    const char *filename;
-    int lineno;
 };
 
 /* Procedures */
@@ -198,17 +259,98 @@ extern void li_string_free(li_str_t *str);
 extern char *li_string_bytes(li_str_t *str);
 extern li_character_t li_string_ref(li_str_t *str, int k);
 extern int li_string_length(li_str_t *str);
+/* Number of bytes in str, not counting the terminating NUL. */
+extern size_t li_string_size(li_str_t *str);
 extern li_cmp_t li_string_cmp(li_str_t *st1, li_str_t *st2);
+extern unsigned long li_string_hash(li_str_t *str);
 extern li_str_t *li_string_append(li_str_t *str1, li_str_t *str2);
 
+/*
+ * A string builder collects bytes in a buffer that grows geometrically, so a
+ * string made from many pieces costs time linear in its size.  Turning one into
+ * a string copies the bytes, and the builder can be appended to afterwards.
+ */
+extern li_string_builder_t *li_string_builder_make(void);
+extern void li_string_builder_append(li_string_builder_t *sb, const char *s,
+        size_t n);
+extern void li_string_builder_append_char(li_string_builder_t *sb,
+        li_character_t c);
+extern li_str_t *li_string_builder_to_string(li_string_builder_t *sb);
+
+/*
+ * Hash tables compare keys with an equivalence predicate and hash them with a
+ * matching hash function, both Scheme procedures.  li_hash_table_make takes
+ * equal? and the hash function which goes with the predicate if they are
+ * NULL.  The hash functions below back eq?, eqv? and equal?.
+ */
+extern li_hash_table_t *li_hash_table_make(li_object *equiv, li_object *hash);
+extern li_object *li_hash_table_ref(li_hash_table_t *table, li_object *key,
+        li_object *def);
+extern li_bool_t li_hash_table_contains(li_hash_table_t *table,
+        li_object *key);
+extern void li_hash_table_set(li_hash_table_t *table, li_object *key,
+        li_object *value);
+extern li_bool_t li_hash_table_delete(li_hash_table_t *table, li_object *key);
+extern size_t li_hash_table_size(li_hash_table_t *table);
+extern unsigned long li_eq_hash(li_object *obj);
+extern unsigned long li_eqv_hash(li_object *obj);
+extern unsigned long li_equal_hash(li_object *obj);
+
 struct li_sym_t {
     LI_OBJ_HEAD;
     char *string;
-    li_sym_t *next;
-    li_sym_t *prev;
-    unsigned int hash;
+    size_t size;
+    unsigned long hash;
+};
+
+/*
+ * Weak references.  A weak box holds on to its value only as long as something
+ * else does; once the value is collected the box is broken and holds #f.  An
+ * ephemeron holds on to its datum as long as its key is reachable without
+ * going through the datum, after which it is broken too.
+ */
+
+struct li_weak_box_t {
+    LI_OBJ_HEAD;
+    li_object *value;
+    li_bool_t broken;
 };
 
+struct li_ephemeron_t {
+    LI_OBJ_HEAD;
+    li_object *key;
+    li_object *datum;
+    li_bool_t broken;
+};
+
+extern li_weak_box_t *li_weak_box(li_object *value);
+extern li_object *li_weak_box_value(li_weak_box_t *box);
+extern li_ephemeron_t *li_ephemeron(li_object *key, li_object *datum);
+extern li_object *li_ephemeron_key(li_ephemeron_t *eph);
+extern li_object *li_ephemeron_datum(li_ephemeron_t *eph);
+
+/*
+ * A guardian holds on to the objects registered with it weakly.  Once one of
+ * them becomes unreachable, the collector keeps it alive after all and queues
+ * it on the guardian instead, from which the program can fetch it to release
+ * whatever it owns, such as a file descriptor, at a time of its choosing.
+ */
+struct li_guardian_t {
+    LI_OBJ_HEAD;
+    li_object **pending;    /* registered objects, held weakly */
+    size_t num_pending;
+    size_t cap_pending;
+    li_object **ready;      /* unreachable objects, held strongly */
+    size_t num_ready;
+    size_t cap_ready;
+};
+
+extern li_guardian_t *li_guardian(void);
+extern void li_guardian_register(li_guardian_t *guardian, li_object *obj);
+
+/* Returns the next queued object, or NULL if there is none. */
+extern li_object *li_guardian_poll(li_guardian_t *guardian);
+
 struct li_transformer_t {
     LI_OBJ_HEAD;
     li_proc_obj_t *proc;
@@ -225,25 +367,207 @@ struct li_type_obj_t {
  */
 
 /*
- * Equivalent to calloc when ptr is NULL, otherwise ptr is realloc'd.
+ * Equivalent to calloc when ptr is NULL, otherwise ptr is realloc'd.  Either
+ * way the whole size counts towards the next collection, so a block which
+ * grows should rather go through li_reallocate.
  */
 extern void *li_allocate(void *ptr, size_t count, size_t size);
 
 /*
- * Allocates and returns an uninitialized object of the given type and throws it
- * on the heap.
+ * Resizes a block of old elements, as returned by li_allocate, to count
+ * elements, of which only the ones added count towards the next collection.
+ */
+extern void *li_reallocate(void *ptr, size_t old, size_t count, size_t size);
+
+/*
+ * Allocates a zeroed object of the given type from the heap.  The object is
+ * taken from a page holding objects of the same size class, so type->size
+ * must be set.
  */
 extern li_object *li_create(const li_type_t *type);
+
+/*
+ * Like li_create, but makes room for size bytes, which must be at least
+ * type->size.  This lets an object keep a small payload right after its
+ * fields instead of in a block of its own.
+ */
+extern li_object *li_create_sized(const li_type_t *type, size_t size);
+
+/*
+ * Initializes the header of an object.  Only objects returned by li_create
+ * are managed by the collector, so this is only useful for static objects.
+ */
 extern void li_object_init(li_object *obj, const li_type_t *type);
 
 /*
- * Frees the given object and any object it holds a strong reference to.
+ * Calls the deinit function of the given object's type, which should release
+ * whatever the object owns (but not the object itself), and returns the
+ * object's slot to the heap.
  */
 extern void li_destroy(li_object *obj);
 
+/*
+ * The garbage collector reclaims every object which cannot be reached from the
+ * root set.  The root set consists of the stack trace (and with it, the
+ * expression and environment of every active evaluation) and anything
+ * registered with the functions below.  The symbol table only holds on to
+ * symbols weakly, so a symbol nothing refers to is collected and interned
+ * again from scratch the next time it is needed.
+ *
+ * Collections only happen at safe points, that is whenever li_gc_safe_point is
+ * called (the evaluator calls it once per step) and enough memory has been
+ * allocated since the last collection.  A C function which holds on to an
+ * object while calling back into the evaluator must therefore register it.
+ *
+ * The heap is split into two generations.  Most collections are minor ones,
+ * which only look at the objects allocated since the previous collection and
+ * promote the survivors to the old generation.  For this to work every store
+ * of a reference into an existing object has to go through
+ * li_gc_write_barrier (li_set_car, li_vector_set and friends already do).
+ */
+
+/* Runs a full collection right away. */
+extern void li_gc_collect(void);
+
+/*
+ * Runs a minor collection if enough memory has been allocated since the last
+ * one, followed by a full one if the old generation has grown enough.
+ */
+extern void li_gc_safe_point(void);
+
+/* Keeps obj alive until it is unprotected.  Calls may be nested. */
+extern void li_gc_protect(li_object *obj);
+extern void li_gc_unprotect(li_object *obj);
+
+/* Keeps whatever the variable ref points to alive until it is removed. */
+extern void li_gc_add_root(li_object **ref);
+extern void li_gc_remove_root(li_object **ref);
+
+/*
+ * Pushes the address of a local variable onto the eval stack and returns the
+ * depth of the stack before the push.  li_gc_pop_roots pops everything above
+ * the given depth.
+ *
+ *     int sp = li_gc_push_root(&head);
+ *     ...
+ *     li_gc_pop_roots(sp);
+ */
+extern int li_gc_push_root(li_object **ref);
+extern void li_gc_pop_roots(int sp);
+
+/*
+ * Must be called before a reference stored in obj, which must have been
+ * returned by li_create, is overwritten or a new one is added (old is NULL
+ * then).  Minor collections learn about old objects pointing to young ones and
+ * incremental ones about references disappearing from under the marker.
+ */
+extern void li_gc_write_barrier(li_object *obj, li_object *old);
+
+/*
+ * Must be called on any reference read out of something which does not keep
+ * it alive, such as a weak box or the symbol table, before handing it out.
+ * While a full collection is marking, an object only reachable that way may
+ * otherwise be freed although the program just got hold of it.
+ */
+extern void li_gc_read_barrier(li_object *obj);
+
+/*
+ * Tells the collector about a weak box, ephemeron or guardian, which it then
+ * updates when what it refers to dies.
+ */
+extern void li_gc_register_weak(li_object *obj);
+
+/*
+ * Runs a full collection if err, the errno of a call which failed to create a
+ * file descriptor, says the process ran out of them: unreachable ports and
+ * sockets may be holding on to some.  Returns whether it did, in which case
+ * the call is worth retrying.  The caller must make sure any object it holds
+ * on to is reachable, as with a safe point.
+ */
+extern li_bool_t li_gc_reclaim_fds(int err);
+
+/*
+ * Regions suit work which allocates a lot of short lived objects, such as
+ * evaluating a single request.  Objects created between li_region_begin and
+ * li_region_end come from pages of their own, and no collection runs in the
+ * meantime unless LI_GC_REGION_SIZE bytes are allocated first.  When the
+ * region ends, the objects which escaped it, being reachable from a root or
+ * stored into an object from outside the region, are kept and everything else
+ * in it is freed at once, without looking at the rest of the heap.  As with a
+ * safe point, the caller must make sure any object it holds on to is
+ * reachable.  Calls may be nested, but only the outermost pair opens and ends
+ * a region: an inner li_region_end frees nothing, and the objects allocated
+ * since the inner li_region_begin are only freed with the rest of the region.
+ *
+ * A collection which has to run while a region is open dissolves it: its
+ * objects are treated like any others from then on, and the region simply
+ * ends without freeing anything.  So does an error or a continuation jumping
+ * out of it, see li_region_abort.
+ */
+extern void li_region_begin(void);
+extern void li_region_end(void);
+
+/* Dissolves any open region and forgets about the pending li_region_ends. */
+extern void li_region_abort(void);
+
+/*
+ * The longest time in microseconds a full collection may stop the program
+ * for.  With a budget, full collections mark incrementally, a slice at a time.
+ * Zero, the default, means no limit.
+ */
+extern void li_gc_set_pause_budget(long usec);
+extern long li_gc_pause_budget(void);
+
+/*
+ * The number of threads which share the stop-the-world part of a full
+ * collection, one by default.  Marking is balanced between them by work
+ * stealing, while the sweep splits up the heap's pages.
+ */
+extern void li_gc_set_threads(int n);
+extern int li_gc_threads(void);
+
+/* Number of buckets in the pause time histogram of li_gc_stats_t. */
+#define LI_GC_PAUSE_BUCKETS 24
+
+typedef struct {
+    const li_type_t *type;
+    size_t count;
+    size_t bytes;
+} li_gc_type_stats_t;
+
+typedef struct {
+    size_t allocations;         /* objects created since startup */
+    size_t allocated_bytes;     /* bytes they took up */
+    size_t heap_bytes;          /* bytes of pages the heap holds on to */
+    size_t minor_collections;
+    size_t major_collections;
+    long pause_total_us;
+    long pause_max_us;
+    /* pauses[0] counts pauses under 2us, pauses[i] those under 2^(i+1)us */
+    size_t pauses[LI_GC_PAUSE_BUCKETS];
+    li_gc_type_stats_t *types;  /* one per type with objects on the heap */
+    size_t num_types;
+} li_gc_stats_t;
+
+/*
+ * Fills stats with the collector's counters and the number of objects of each
+ * type on the heap, along with the bytes they take up.  Objects which died
+ * since the last collection are still counted.  stats->types is allocated
+ * with malloc and must be freed by the caller.
+ */
+extern void li_gc_stats(li_gc_stats_t *stats);
+
+/*
+ * Writes every object on the heap, the references between them and the roots
+ * to fp in the format described in dump.c.  The li-heap program reads it and
+ * reports what keeps the most memory alive.
+ */
+extern void li_heap_dump(FILE *fp);
+
 /** Object constructors. */
 
-extern li_object *li_character(li_character_t c);
+#define li_character(c)                 \
+    li_immediate((li_character_t)(c), LI_TAG_CHARACTER)
 extern li_object *li_lambda(li_sym_t *name, li_object *vars, li_object *body,
         li_env_t *env);
 extern li_object *li_macro(li_proc_obj_t *proc);
@@ -251,6 +575,28 @@ extern li_pair_t *li_pair(li_object *car, li_object *cdr);
 extern li_object *li_primitive_procedure(li_object *(*proc)(li_object *));
 extern li_object *li_special_form(li_special_form_t *proc);
 extern li_sym_t *li_symbol(const char *s);
+
+/*
+ * Interns the symbol named by the n bytes at s, which need not be followed by
+ * a NUL.
+ */
+extern li_sym_t *li_symbol_n(const char *s, size_t n);
+
+/*
+ * Symbols the evaluator and the built in macros look for.  They are interned
+ * once by li_setup_environment and kept alive from then on, so they can be
+ * compared by identity without being looked up every time.
+ */
+extern li_sym_t *li_sym_quote;
+extern li_sym_t *li_sym_quasiquote;
+extern li_sym_t *li_sym_unquote;
+extern li_sym_t *li_sym_unquote_splicing;
+extern li_sym_t *li_sym_if;
+extern li_sym_t *li_sym_else;
+extern li_sym_t *li_sym_arrow;
+extern li_sym_t *li_sym_begin;
+extern li_sym_t *li_sym_lambda;
+extern void li_intern_well_known_symbols(void);
 extern li_object *li_type_obj(const li_type_t *type);
 
 /*
@@ -258,12 +604,10 @@ extern li_object *li_type_obj(const li_type_t *type);
  */
 extern li_object *li_vector(li_object *lst);
 
-/** EOF, is just a special symbol. */
-#define li_eof                          ((li_object *)li_symbol("#<eof>"))
-
-extern li_object *li_false;
-extern li_object *li_true;
-extern li_object *li_void;
+#define li_eof                          li_immediate(0, LI_TAG_EOF)
+#define li_false                        li_immediate(0, LI_TAG_BOOLEAN)
+#define li_true                         li_immediate(1, LI_TAG_BOOLEAN)
+#define li_void                         li_immediate(0, LI_TAG_VOID)
 #define li_boolean(p)                   ((p) ? li_true : li_false)
 
 /** Let cons be an alias for pair. */
@@ -283,9 +627,9 @@ extern int li_length(li_object *obj);
 extern li_object *li_list_reverse(li_object *lst);
 
 /** Type casting. */
-#define li_chr_uint(obj)                ((li_character_obj_t *)(obj))->character
-#define li_to_character(obj)            li_chr_uint(obj)
-#define li_to_integer(obj)              (li_num_to_int((li_num_t *)(obj)))
+#define li_to_character(obj)            ((li_character_t)li_immediate_value(obj))
+#define li_to_integer(obj)              \
+    (li_is_fixnum(obj) ? li_fixnum_value(obj) : li_num_to_long((li_num_t *)(obj)))
 #define li_to_symbol(obj)               ((li_sym_t *)(obj))->string
 #define li_to_userdata(obj)             (obj)->data.userdata.v
 #define li_to_type(obj)                 ((li_type_obj_t *)(obj))->val
@@ -293,28 +637,37 @@ extern li_object *li_list_reverse(li_object *lst);
 #define li_macro_primitive(obj)         ((li_macro_t *)(obj))->special_form
 
 #define li_is_boolean(obj)              li_is_type(obj, &li_type_boolean)
-#define li_is_bytevector(obj)           li_is_type(obj, &li_type_bytevector)
+#define li_is_bytevector(obj)           \
+    li_is_object_type(obj, &li_type_bytevector)
 #define li_is_character(obj)            li_is_type(obj, &li_type_character)
-#define li_is_environment(obj)          li_is_type(obj, &li_type_environment)
-#define li_is_macro(obj)                li_is_type(obj, &li_type_macro)
+#define li_is_environment(obj)          \
+    li_is_object_type(obj, &li_type_environment)
+#define li_is_hash_table(obj)           \
+    li_is_object_type(obj, &li_type_hash_table)
+#define li_is_macro(obj)                li_is_object_type(obj, &li_type_macro)
 #define li_is_number(obj)               li_is_type(obj, &li_type_number)
-#define li_is_pair(obj)                 li_is_type(obj, &li_type_pair)
-#define li_is_port(obj)                 li_is_type(obj, &li_type_port)
-#define li_is_procedure(obj)            li_is_type(obj, &li_type_procedure)
+#define li_is_pair(obj)                 li_is_object_type(obj, &li_type_pair)
+#define li_is_port(obj)                 li_is_object_type(obj, &li_type_port)
+#define li_is_procedure(obj)            \
+    li_is_object_type(obj, &li_type_procedure)
 #define li_is_primitive_procedure(obj)  \
     (li_is_procedure(obj) && li_proc_prim(obj) != NULL)
 
-#define li_is_type_obj(obj)             li_is_type(obj, &li_type_type)
-#define li_is_string(obj)               li_is_type(obj, &li_type_string)
-#define li_is_symbol(obj)               li_is_type(obj, &li_type_symbol)
-#define li_is_vector(obj)               li_is_type(obj, &li_type_vector)
-
-#define li_is_integer(obj)              \
-    (li_is_number(obj) && li_num_is_integer((li_num_t *)(obj)))
-
-#define li_lock(obj)                    ((obj)->locked = LI_TRUE)
-#define li_unlock(obj)                  ((obj)->locked = LI_FALSE)
-#define li_is_locked(obj)               (obj)->locked
+#define li_is_type_obj(obj)             li_is_object_type(obj, &li_type_type)
+#define li_is_string(obj)               li_is_object_type(obj, &li_type_string)
+#define li_is_string_builder(obj)       \
+    li_is_object_type(obj, &li_type_string_builder)
+#define li_is_symbol(obj)               li_is_object_type(obj, &li_type_symbol)
+#define li_is_vector(obj)               li_is_object_type(obj, &li_type_vector)
+#define li_is_weak_box(obj)             \
+    li_is_object_type(obj, &li_type_weak_box)
+#define li_is_ephemeron(obj)            \
+    li_is_object_type(obj, &li_type_ephemeron)
+#define li_is_guardian(obj)             \
+    li_is_object_type(obj, &li_type_guardian)
+
+#define li_is_integer(obj)              (li_is_fixnum(obj) || \
+    (li_is_number(obj) && li_num_is_integer((li_num_t *)(obj))))
 
 /** Accessors for pairs. */
 extern li_object *li_car(li_object *obj);
@@ -323,8 +676,19 @@ extern li_object *li_cdr(li_object *obj);
 #define li_cadr(obj)                    li_car(li_cdr(obj))
 #define li_cdar(obj)                    li_cdr(li_car(obj))
 #define li_cddr(obj)                    li_cdr(li_cdr(obj))
-#define li_set_car(obj1, obj2)          (((li_pair_t *)(obj1))->car = (obj2))
-#define li_set_cdr(obj1, obj2)          (((li_pair_t *)(obj1))->cdr = (obj2))
+
+/* Store obj into the car or cdr of pair and return obj. */
+extern li_object *li_set_car(li_object *pair, li_object *obj);
+extern li_object *li_set_cdr(li_object *pair, li_object *obj);
+
+/*
+ * Source locations, which the reader records for the pairs it creates.  They
+ * are kept on the side and forgotten when the pair is collected.
+ */
+extern void li_pair_set_location(li_object *pair, const char *filename,
+        int lineno);
+extern li_bool_t li_pair_location(li_object *pair, const char **filename,
+        int *lineno);
 
 /** Vector accessors. */
 extern li_vector_t *li_make_vector(int k, li_object *fill);
@@ -397,6 +761,9 @@ extern void li_parse_args(li_object *args, const char *fmt, ...);
 void li_define_boolean_functions(li_env_t *env);
 extern void li_define_bytevector_functions(li_env_t *env);
 extern void li_define_char_functions(li_env_t *env);
+extern void li_define_dump_functions(li_env_t *env);
+extern void li_define_gc_functions(li_env_t *env);
+extern void li_define_hash_functions(li_env_t *env);
 extern void li_define_number_functions(li_env_t *env);
 extern void li_define_pair_functions(li_env_t *env);
 extern void li_define_port_functions(li_env_t *env);
@@ -404,6 +771,7 @@ extern void li_define_procedure_functions(li_env_t *env);
 extern void li_define_string_functions(li_env_t *env);
 extern void li_define_symbol_functions(li_env_t *env);
 extern void li_define_vector_functions(li_env_t *env);
+extern void li_define_weak_functions(li_env_t *env);
 extern void li_init_syntax(li_env_t *env);
 
 #endif
@@ -0,0 +1,149 @@
+#ifndef _li_gc_h
+#define _li_gc_h
+
+/*
+ * Interface between the allocator (alloc.c) and the collector (gc.c).
+ */
+
+/* Number of bytes allocated since the last sweep. */
+extern size_t li_heap_allocated(void);
+
+/* Whether new objects are born marked, which they are while marking. */
+extern void li_heap_allocate_black(li_bool_t black);
+
+/*
+ * Sets the mark bit of obj, which is safe to do from several threads at once.
+ * Returns false if it was set already, or if obj is not on the heap (e.g. a
+ * static object), or if minor is true and obj was promoted to the old
+ * generation; there is nothing to trace in any of these cases.
+ */
+extern li_bool_t li_heap_mark(li_object *obj, li_bool_t minor);
+
+/*
+ * Whether obj survives the collection being marked, assuming marking is over:
+ * it is marked, old during a minor collection, or not on the heap at all.
+ */
+extern li_bool_t li_heap_live(li_object *obj, li_bool_t minor);
+
+/* Adds obj to the remembered set if it is old, or outside the open region. */
+extern void li_heap_remember(li_object *obj);
+
+/* Marks the children of every object in the remembered set. */
+extern void li_heap_mark_remembered(void);
+
+/*
+ * Destroys every unmarked object, promotes the survivors to the old
+ * generation and releases pages which became empty.  A minor sweep only
+ * visits the pages which received objects since the last sweep and leaves old
+ * objects alone.  Either sweep empties the remembered set.  Stores the number
+ * of bytes promoted in promoted and returns the number of bytes still in use,
+ * which is only known after a full sweep.
+ */
+extern size_t li_heap_sweep(li_bool_t minor, size_t *promoted);
+
+/*
+ * A full sweep split up so that several threads can share it.  Returns the
+ * number of pages to sweep, each of which must then be passed to
+ * li_heap_sweep_page exactly once before calling li_heap_sweep_end.
+ */
+extern size_t li_heap_sweep_begin(void);
+
+/*
+ * Sweeps the ith page like li_heap_sweep and adds the number of bytes it
+ * promoted to promoted.  Different pages may be swept from different threads
+ * at the same time.  Dead objects with a deinit function are left alone.
+ */
+extern void li_heap_sweep_page(size_t i, size_t *promoted);
+
+/*
+ * Destroys the objects li_heap_sweep_page left alone, releases pages which
+ * became empty and returns the number of bytes still in use.
+ */
+extern size_t li_heap_sweep_end(void);
+
+/*
+ * Opens a region: objects are allocated from pages of their own until it ends
+ * or is dissolved.  There is at most one region open at a time.
+ */
+extern void li_heap_region_begin(void);
+
+/* Whether a region is open. */
+extern li_bool_t li_heap_region_open(void);
+
+/* Number of bytes allocated since the open region began. */
+extern size_t li_heap_region_allocated(void);
+
+/*
+ * Restricts marking to the objects of the open region.  Any other object is
+ * taken to be alive and neither marked nor traced.
+ */
+extern void li_heap_region_mark(void);
+
+/*
+ * Destroys the unmarked objects of the region and frees the pages this leaves
+ * empty, after which the region is closed and its survivors are ordinary young
+ * objects.  Returns the number of bytes which survived.
+ */
+extern size_t li_heap_region_end(void);
+
+/* Closes the region without freeing anything. */
+extern void li_heap_region_dissolve(void);
+
+/*
+ * Fills in the allocation counters of stats and counts the objects of each
+ * type on the heap.
+ */
+extern void li_heap_stats(li_gc_stats_t *stats);
+
+/*
+ * Calls fn on every object on the heap along with the size of its slot.  Dead
+ * objects which were not swept yet are included.
+ */
+extern void li_heap_each(void (*fn)(li_object *, size_t, void *), void *data);
+
+/*
+ * Forgets the source locations of the pairs which did not survive the
+ * collection or region being marked, see li_heap_live.
+ */
+extern void li_pair_locations_sweep(li_bool_t minor);
+
+/*
+ * A string, bytevector or vector copied out of part of another one may share
+ * its storage instead, as long as neither of them changes.  The object which
+ * owns the storage is the slice's parent, and is not kept alive by it: a slice
+ * whose parent is about to be swept is given storage of its own first.  An
+ * object about to change, slice or parent, must likewise stop sharing first.
+ */
+typedef void li_unshare_f(li_object *slice);
+
+/* Parts smaller than this many bytes are cheaper to copy than to share. */
+#define LI_SLICE_MIN_SIZE 64
+
+/*
+ * Registers slice as sharing the storage of parent.  unshare must give the
+ * slice storage of its own, copied from the parent's, and may be called more
+ * than once.
+ */
+extern void li_gc_add_slice(li_object *slice, li_object *parent,
+        li_unshare_f *unshare);
+
+/* Unshares every slice of parent. */
+extern void li_gc_unshare_slices(li_object *parent);
+
+typedef void li_visit_f(li_object *, void *);
+
+/* Calls fn on every root, without marking anything. */
+extern void li_gc_visit_roots(li_visit_f *fn, void *data);
+
+/* Calls fn on every object obj refers to, without marking anything. */
+extern void li_gc_visit_children(li_object *obj, li_visit_f *fn, void *data);
+
+/*
+ * Destroys every object and releases all pages.  Shared libraries are closed
+ * last since other objects may have their type defined in one of them.
+ */
+extern void li_heap_free(void);
+
+extern const li_type_t li_type_dl;
+
+#endif
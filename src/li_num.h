@@ -9,16 +9,25 @@ typedef long li_int_t;
 
 /* li_nat.c */
 
+/*
+ * A natural number of any size: data holds it as long as it fits, otherwise
+ * big points to a bignum on the heap.  Whatever holds on to a li_nat_t on the
+ * heap must mark it with li_nat_mark.
+ */
 typedef struct {
     unsigned long data;
+    li_object *big;
 } li_nat_t;
 
 extern size_t li_nat_read(li_nat_t *dst, const char *s);
 extern li_nat_t li_nat_parse(const char *s);
+extern size_t li_nat_to_chars(li_nat_t x, char *s, size_t n);
 extern li_nat_t li_nat_with_int(li_int_t x);
 extern li_dec_t li_nat_to_dec(li_nat_t x);
 extern li_int_t li_nat_to_int(li_nat_t x);
 extern li_bool_t li_nat_is_zero(li_nat_t x);
+extern li_bool_t li_nat_is_odd(li_nat_t x);
+extern void li_nat_mark(li_nat_t x);
 extern li_nat_t li_nat_add(li_nat_t x, li_nat_t y);
 extern li_nat_t li_nat_mul(li_nat_t x, li_nat_t y);
 extern li_nat_t li_nat_sub(li_nat_t x, li_nat_t y);
@@ -36,7 +45,9 @@ typedef struct {
 } li_rat_t;
 
 extern li_rat_t li_rat_make(li_bool_t neg, li_nat_t num, li_nat_t den);
-extern li_rat_t li_rat_with_int(int x);
+/* Brings x to lowest terms, which the arithmetic does not always do. */
+extern li_rat_t li_rat_norm(li_rat_t x);
+extern li_rat_t li_rat_with_int(li_int_t x);
 extern li_rat_t li_rat_with_nat(li_nat_t z);
 
 extern li_bool_t li_rat_is_negative(li_rat_t x);
@@ -62,7 +73,7 @@ extern li_dec_t li_rat_to_dec(li_rat_t x);
 #define li_num_is_complex(x) (LI_TRUE)
 #define li_num_is_real(x) (LI_TRUE)
 #define li_num_is_rational(x) (li_num_is_exact(x))
-#define li_num_is_exact(x) ((x)->exact)
+#define li_num_is_exact(x) (li_is_fixnum(x) || (x)->exact)
 #define li_num_is_inexact(x) (!li_num_is_exact(x))
 
 extern li_cmp_t li_num_cmp(li_num_t *x, li_num_t *y);
@@ -83,10 +94,10 @@ extern li_num_t *li_num_neg(li_num_t *x);
 
 #define li_num_abs(x) (li_num_is_negative(x) ? li_num_neg(x) : (x))
 
-#define li_num_floor(x) (li_num_with_int(floor(li_num_to_dec(x))))
-#define li_num_ceiling(x) (li_num_with_int(ceil(li_num_to_dec(x))))
-#define li_num_truncate(x) (li_num_with_int(ceil(li_num_to_dec(x)-0.5)))
-#define li_num_round(x) (li_num_with_int(floor(li_num_to_dec(x)+0.5)))
+#define li_num_floor(x) (li_num_with_long(floor(li_num_to_dec(x))))
+#define li_num_ceiling(x) (li_num_with_long(ceil(li_num_to_dec(x))))
+#define li_num_truncate(x) (li_num_with_long(ceil(li_num_to_dec(x)-0.5)))
+#define li_num_round(x) (li_num_with_long(floor(li_num_to_dec(x)+0.5)))
 
 #define li_num_exp(x) (li_num_with_dec(exp(li_num_to_dec(x))))
 #define li_num_log(x) (li_num_with_dec(log(li_num_to_dec(x))))
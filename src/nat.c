@@ -3,14 +3,368 @@
 
 #include <assert.h>
 #include <ctype.h>
+#include <stdint.h>
+#include <string.h>
+
+/*
+ * Natural numbers.  A value which fits in an unsigned long is kept in data,
+ * where the arithmetic below works on it directly and only checks for
+ * overflow.  Anything larger lives in a bignum object: an array of 32 bit
+ * digits, least significant first and without leading zeros.  A value is only
+ * ever kept in a bignum if it does not fit in data, so the two never need to
+ * be compared with each other.
+ *
+ * Bignums are never modified once made, and are only referred to by the
+ * numbers holding them, which mark them.  Collections only happen at safe
+ * points, so the ones made along the way while computing a result need no
+ * protection.
+ */
+
+typedef uint32_t li_digit_t;
+typedef uint64_t li_ddigit_t;
+
+#define LI_DIGIT_BITS   32
+#define LI_DIGIT_BASE   ((li_ddigit_t)1 << LI_DIGIT_BITS)
+
+/* Digits of an unsigned long. */
+#define LI_LONG_DIGITS  \
+    ((sizeof(unsigned long) + sizeof(li_digit_t) - 1) / sizeof(li_digit_t))
+
+/* Below this many digits, the schoolbook method beats Karatsuba's. */
+#define LI_KARATSUBA_CUTOFF 32
+
+/* Decimal digits converted at a time, and the power of ten they make. */
+#define LI_DEC_CHUNK    9
+#define LI_DEC_BASE     1000000000u
+
+typedef struct {
+    LI_OBJ_HEAD;
+    size_t size;
+    li_digit_t *digits;
+} li_big_t;
+
+static void big_deinit(li_big_t *big)
+{
+    free(big->digits);
+}
+
+static void big_write(li_big_t *big, li_port_t *port)
+{
+    (void)big;
+    li_port_printf(port, "#[bignum]");
+}
+
+const li_type_t li_type_bignum = {
+    .name = "bignum",
+    .size = sizeof(li_big_t),
+    .deinit = (li_deinit_f *)big_deinit,
+    .write = (li_write_f *)big_write,
+};
+
+#define li_big(x)       ((li_big_t *)(x).big)
+
+static li_digit_t *li_digits_new(size_t n)
+{
+    return li_allocate(NULL, n ? n : 1, sizeof(li_digit_t));
+}
+
+/* Number of digits of d[0..n) without the leading zeros. */
+static size_t li_digits_trim(const li_digit_t *d, size_t n)
+{
+    while (n && !d[n - 1])
+        n--;
+    return n;
+}
+
+/*
+ * Makes a natural number out of n digits, taking over d, which must have come
+ * from li_digits_new.
+ */
+static li_nat_t li_nat_make(li_digit_t *d, size_t n)
+{
+    li_nat_t z;
+    li_big_t *big;
+    n = li_digits_trim(d, n);
+    z.big = NULL;
+    z.data = 0;
+    if (n <= LI_LONG_DIGITS) {
+        while (n--)
+            z.data = (z.data << (LI_DIGIT_BITS / 2) << (LI_DIGIT_BITS / 2))
+                | d[n];
+        free(d);
+        return z;
+    }
+    big = (li_big_t *)li_create(&li_type_bignum);
+    big->size = n;
+    big->digits = d;
+    z.big = (li_object *)big;
+    return z;
+}
+
+/*
+ * Points *d at the digits of x and returns how many there are.  buf must have
+ * room for LI_LONG_DIGITS digits, which is where those of a small value go.
+ */
+static size_t li_nat_digits(li_nat_t x, li_digit_t *buf, const li_digit_t **d)
+{
+    size_t n = 0;
+    if (x.big) {
+        *d = li_big(x)->digits;
+        return li_big(x)->size;
+    }
+    for (; x.data; x.data >>= LI_DIGIT_BITS / 2, x.data >>= LI_DIGIT_BITS / 2)
+        buf[n++] = (li_digit_t)x.data;
+    *d = buf;
+    return n;
+}
+
+static int li_digits_cmp(const li_digit_t *a, size_t n,
+        const li_digit_t *b, size_t m)
+{
+    n = li_digits_trim(a, n);
+    m = li_digits_trim(b, m);
+    if (n != m)
+        return n < m ? -1 : 1;
+    while (n--)
+        if (a[n] != b[n])
+            return a[n] < b[n] ? -1 : 1;
+    return 0;
+}
+
+/* Adds b[0..m) to a[0..n), n >= m, and returns the carry out of a[n - 1]. */
+static li_digit_t li_digits_add_to(li_digit_t *a, size_t n,
+        const li_digit_t *b, size_t m)
+{
+    li_ddigit_t t = 0;
+    size_t i;
+    for (i = 0; i < m; i++) {
+        t += (li_ddigit_t)a[i] + b[i];
+        a[i] = (li_digit_t)t;
+        t >>= LI_DIGIT_BITS;
+    }
+    for (; t && i < n; i++) {
+        t += a[i];
+        a[i] = (li_digit_t)t;
+        t >>= LI_DIGIT_BITS;
+    }
+    return (li_digit_t)t;
+}
+
+/* Subtracts b[0..m) from a[0..n), which must be at least as large. */
+static void li_digits_sub_from(li_digit_t *a, size_t n,
+        const li_digit_t *b, size_t m)
+{
+    li_digit_t borrow = 0;
+    size_t i;
+    for (i = 0; i < m; i++) {
+        li_ddigit_t t = (li_ddigit_t)a[i] - b[i] - borrow;
+        a[i] = (li_digit_t)t;
+        borrow = (t >> LI_DIGIT_BITS) != 0;
+    }
+    for (; borrow && i < n; i++)
+        borrow = a[i]-- == 0;
+    assert(!borrow);
+}
+
+/*
+ * Multiplies a[0..n) by b[0..m) into out[0..n + m) with the schoolbook method,
+ * or Karatsuba's once both have enough digits.
+ */
+static void li_digits_mul(const li_digit_t *a, size_t n,
+        const li_digit_t *b, size_t m, li_digit_t *out)
+{
+    li_digit_t *sa, *sb, *mid;
+    size_t h, i, j, na, nb;
+    if (n < m) {
+        const li_digit_t *t = a;
+        a = b, b = t;
+        i = n, n = m, m = i;
+    }
+    memset(out, 0, (n + m) * sizeof(*out));
+    if (m < LI_KARATSUBA_CUTOFF) {
+        for (j = 0; j < m; j++) {
+            li_ddigit_t t = 0;
+            if (!b[j])
+                continue;
+            for (i = 0; i < n; i++) {
+                t += (li_ddigit_t)a[i] * b[j] + out[i + j];
+                out[i + j] = (li_digit_t)t;
+                t >>= LI_DIGIT_BITS;
+            }
+            out[n + j] = (li_digit_t)t;
+        }
+        return;
+    }
+    if (2 * m <= n) {
+        /* Lopsided: multiply b by one slice of a as long as b at a time. */
+        li_digit_t *part = li_digits_new(2 * m);
+        for (i = 0; i < n; i += m) {
+            j = n - i < m ? n - i : m;
+            li_digits_mul(a + i, j, b, m, part);
+            li_digits_add_to(out + i, n + m - i, part, j + m);
+        }
+        free(part);
+        return;
+    }
+    /*
+     * With a = a1 B^h + a0 and b = b1 B^h + b0, a b is
+     * a1 b1 B^2h + ((a0 + a1)(b0 + b1) - a0 b0 - a1 b1) B^h + a0 b0.
+     */
+    h = n / 2;
+    li_digits_mul(a, h, b, h, out);
+    li_digits_mul(a + h, n - h, b + h, m - h, out + 2 * h);
+    na = (h > n - h ? h : n - h) + 1;
+    nb = (h > m - h ? h : m - h) + 1;
+    sa = li_digits_new(na);
+    sb = li_digits_new(nb);
+    mid = li_digits_new(na + nb);
+    memset(sa, 0, na * sizeof(*sa));
+    memset(sb, 0, nb * sizeof(*sb));
+    memcpy(sa, a, h * sizeof(*sa));
+    li_digits_add_to(sa, na, a + h, n - h);
+    memcpy(sb, b, h * sizeof(*sb));
+    li_digits_add_to(sb, nb, b + h, m - h);
+    li_digits_mul(sa, na, sb, nb, mid);
+    li_digits_sub_from(mid, na + nb, out, 2 * h);
+    li_digits_sub_from(mid, na + nb, out + 2 * h, n + m - 2 * h);
+    /* The middle term is less than B^(n + m - h), whatever its length. */
+    li_digits_add_to(out + h, n + m - h, mid,
+            li_digits_trim(mid, na + nb));
+    free(sa);
+    free(sb);
+    free(mid);
+}
+
+/* Divides a[0..n) by d in place and returns the remainder. */
+static li_digit_t li_digits_div_small(li_digit_t *a, size_t n, li_digit_t d)
+{
+    li_ddigit_t r = 0;
+    while (n--) {
+        r = (r << LI_DIGIT_BITS) | a[n];
+        a[n] = (li_digit_t)(r / d);
+        r %= d;
+    }
+    return (li_digit_t)r;
+}
+
+static int li_digit_clz(li_digit_t d)
+{
+    int s = 0;
+    while (!(d & ((li_digit_t)1 << (LI_DIGIT_BITS - 1)))) {
+        d <<= 1;
+        s++;
+    }
+    return s;
+}
+
+/*
+ * Long division of a[0..n) by b[0..m), following Knuth's algorithm D.  b must
+ * not have leading zeros and n >= m.  The quotient goes to q[0..n - m + 1)
+ * and the remainder to r[0..m); either may be NULL.
+ */
+static void li_digits_divmod(const li_digit_t *a, size_t n,
+        const li_digit_t *b, size_t m, li_digit_t *q, li_digit_t *r)
+{
+    li_digit_t *u, *v;
+    size_t i, j;
+    int s;
+    assert(m && b[m - 1] && n >= m);
+    if (m == 1) {
+        li_digit_t *t = li_digits_new(n), rem;
+        memcpy(t, a, n * sizeof(*t));
+        rem = li_digits_div_small(t, n, b[0]);
+        if (q)
+            memcpy(q, t, n * sizeof(*q));
+        if (r)
+            r[0] = rem;
+        free(t);
+        return;
+    }
+    /* Normalize so that the top digit of the divisor has its top bit set. */
+    s = li_digit_clz(b[m - 1]);
+    u = li_digits_new(n + 1);
+    v = li_digits_new(m);
+    for (i = m; i--; )
+        v[i] = (li_digit_t)((((li_ddigit_t)b[i] << LI_DIGIT_BITS)
+                    | (i ? b[i - 1] : 0)) >> (LI_DIGIT_BITS - s));
+    u[n] = (li_digit_t)(((li_ddigit_t)a[n - 1] << s) >> LI_DIGIT_BITS);
+    for (i = n; i--; )
+        u[i] = (li_digit_t)((((li_ddigit_t)a[i] << LI_DIGIT_BITS)
+                    | (i ? a[i - 1] : 0)) >> (LI_DIGIT_BITS - s));
+    for (j = n - m + 1; j--; ) {
+        li_ddigit_t num = ((li_ddigit_t)u[j + m] << LI_DIGIT_BITS)
+            | u[j + m - 1];
+        li_ddigit_t qhat = num / v[m - 1], rhat = num % v[m - 1];
+        int64_t t, k = 0;
+        while (qhat >= LI_DIGIT_BASE || qhat * v[m - 2]
+                > ((rhat << LI_DIGIT_BITS) | u[j + m - 2])) {
+            qhat--;
+            rhat += v[m - 1];
+            if (rhat >= LI_DIGIT_BASE)
+                break;
+        }
+        for (i = 0; i < m; i++) {
+            li_ddigit_t p = qhat * v[i];
+            t = (int64_t)u[i + j] - k - (int64_t)(p & (LI_DIGIT_BASE - 1));
+            u[i + j] = (li_digit_t)t;
+            k = (int64_t)(p >> LI_DIGIT_BITS) - (t >> LI_DIGIT_BITS);
+        }
+        t = (int64_t)u[j + m] - k;
+        u[j + m] = (li_digit_t)t;
+        if (t < 0) {
+            /* qhat was one too large: add the divisor back. */
+            qhat--;
+            u[j + m] += li_digits_add_to(u + j, m, v, m);
+        }
+        if (q)
+            q[j] = (li_digit_t)qhat;
+    }
+    if (r)
+        for (i = 0; i < m; i++)
+            r[i] = (li_digit_t)((((li_ddigit_t)u[i + 1] << LI_DIGIT_BITS)
+                        | u[i]) >> s);
+    free(u);
+    free(v);
+}
+
+/*
+ * Conversion from and to decimal, LI_DEC_CHUNK digits at a time so that most
+ * of the work is done on digits rather than characters.
+ */
 
 extern size_t li_nat_read(li_nat_t *dst, const char *s)
 {
-    size_t n;
+    li_digit_t *d;
+    size_t n, i, size = 0;
+    unsigned long x = 0;
     for (n = 0; s[n] && isdigit(s[n]); ++n)
         ;
-    if (n)
-        dst->data = atol(s);
+    if (!n)
+        return 0;
+    for (i = 0; i < n && x <= (ULONG_MAX - 9) / 10; i++)
+        x = x * 10 + (s[i] - '0');
+    if (i == n) {
+        dst->data = x;
+        dst->big = NULL;
+        return n;
+    }
+    /* A decimal digit is about 3.3 bits. */
+    d = li_digits_new(n / 9 + 2);
+    for (i = 0; i < n; ) {
+        li_digit_t chunk = 0, scale = 1;
+        li_ddigit_t t;
+        size_t j;
+        for (; i < n && scale < LI_DEC_BASE; i++, scale *= 10)
+            chunk = chunk * 10 + (s[i] - '0');
+        for (t = chunk, j = 0; j < size; j++) {
+            t += (li_ddigit_t)d[j] * scale;
+            d[j] = (li_digit_t)t;
+            t >>= LI_DIGIT_BITS;
+        }
+        if (t)
+            d[size++] = (li_digit_t)t;
+    }
+    *dst = li_nat_make(d, size);
     return n;
 }
 
@@ -21,76 +375,323 @@ extern li_nat_t li_nat_parse(const char *s)
     return x;
 }
 
+/* Like snprintf, writes at most n characters of x to s, counting the NUL. */
+extern size_t li_nat_to_chars(li_nat_t x, char *s, size_t n)
+{
+    li_digit_t *d, *chunks = NULL;
+    size_t size, len, i, k;
+    char small[3 * sizeof(unsigned long) + 1], *buf = small;
+    if (!x.big) {
+        len = sprintf(buf, "%lu", x.data);
+    } else {
+        size = li_big(x)->size;
+        d = li_digits_new(size);
+        memcpy(d, li_big(x)->digits, size * sizeof(*d));
+        /* 32 bits are a little under 10 decimal digits. */
+        chunks = li_digits_new(size * 10 / LI_DEC_CHUNK + 2);
+        for (k = 0; size; k++) {
+            chunks[k] = li_digits_div_small(d, size, LI_DEC_BASE);
+            size = li_digits_trim(d, size);
+        }
+        free(d);
+        buf = li_allocate(NULL, k * LI_DEC_CHUNK + 1, sizeof(char));
+        len = sprintf(buf, "%lu", (unsigned long)chunks[k - 1]);
+        for (i = k - 1; i--; )
+            len += sprintf(buf + len, "%09lu", (unsigned long)chunks[i]);
+        free(chunks);
+    }
+    if (n) {
+        i = len < n ? len : n - 1;
+        memcpy(s, buf, i);
+        s[i] = '\0';
+    }
+    if (buf != small)
+        free(buf);
+    return len;
+}
+
 extern li_nat_t li_nat_with_int(li_int_t x)
 {
     li_nat_t z;
-    z.data = labs(x);
+    z.data = x < 0 ? -(unsigned long)x : (unsigned long)x;
+    z.big = NULL;
     return z;
 }
 
 extern li_dec_t li_nat_to_dec(li_nat_t x)
 {
-    return (li_dec_t)x.data;
+    li_dec_t y = 0;
+    size_t i;
+    if (!x.big)
+        return (li_dec_t)x.data;
+    for (i = li_big(x)->size; i--; )
+        y = y * LI_DIGIT_BASE + li_big(x)->digits[i];
+    return y;
 }
 
 extern li_int_t li_nat_to_int(li_nat_t x)
 {
+    if (x.big || x.data > LONG_MAX)
+        return LONG_MAX;
     return (li_int_t)x.data;
 }
 
 extern li_bool_t li_nat_is_zero(li_nat_t x)
 {
-    return x.data == 0;
+    return !x.big && x.data == 0;
+}
+
+extern li_bool_t li_nat_is_odd(li_nat_t x)
+{
+    return x.big ? li_big(x)->digits[0] & 1 : x.data & 1;
+}
+
+extern void li_nat_mark(li_nat_t x)
+{
+    li_mark(x.big);
 }
 
 extern li_nat_t li_nat_add(li_nat_t x, li_nat_t y)
 {
-    x.data += y.data;
-    return x;
+    li_digit_t bx[LI_LONG_DIGITS], by[LI_LONG_DIGITS], *z;
+    const li_digit_t *dx, *dy;
+    size_t n, m;
+    unsigned long sum;
+    if (!x.big && !y.big && !__builtin_add_overflow(x.data, y.data, &sum)) {
+        x.data = sum;
+        return x;
+    }
+    n = li_nat_digits(x, bx, &dx);
+    m = li_nat_digits(y, by, &dy);
+    if (n < m) {
+        const li_digit_t *t = dx;
+        size_t k = n;
+        dx = dy, dy = t;
+        n = m, m = k;
+    }
+    z = li_digits_new(n + 1);
+    memcpy(z, dx, n * sizeof(*z));
+    z[n] = li_digits_add_to(z, n, dy, m);
+    return li_nat_make(z, n + 1);
 }
 
 extern li_nat_t li_nat_mul(li_nat_t x, li_nat_t y)
 {
-    x.data *= y.data;
-    return x;
+    li_digit_t bx[LI_LONG_DIGITS], by[LI_LONG_DIGITS], *z;
+    const li_digit_t *dx, *dy;
+    size_t n, m;
+    unsigned long prod;
+    if (!x.big && !y.big && !__builtin_mul_overflow(x.data, y.data, &prod)) {
+        x.data = prod;
+        return x;
+    }
+    n = li_nat_digits(x, bx, &dx);
+    m = li_nat_digits(y, by, &dy);
+    z = li_digits_new(n + m);
+    li_digits_mul(dx, n, dy, m, z);
+    return li_nat_make(z, n + m);
 }
 
 extern li_nat_t li_nat_sub(li_nat_t x, li_nat_t y)
 {
-    assert(x.data >= y.data);
-    x.data -= y.data;
-    return x;
+    li_digit_t bx[LI_LONG_DIGITS], by[LI_LONG_DIGITS], *z;
+    const li_digit_t *dx, *dy;
+    size_t n, m;
+    assert(li_nat_cmp(x, y) != LI_CMP_LT);
+    if (!x.big) {
+        x.data -= y.data;
+        return x;
+    }
+    n = li_nat_digits(x, bx, &dx);
+    m = li_nat_digits(y, by, &dy);
+    z = li_digits_new(n);
+    memcpy(z, dx, n * sizeof(*z));
+    li_digits_sub_from(z, n, dy, m);
+    return li_nat_make(z, n);
+}
+
+/* Stores the quotient of x by y in q and the remainder in r, if not NULL. */
+static void li_nat_divmod(li_nat_t x, li_nat_t y, li_nat_t *q, li_nat_t *r)
+{
+    li_digit_t bx[LI_LONG_DIGITS], by[LI_LONG_DIGITS], *dq = NULL, *dr = NULL;
+    const li_digit_t *dx, *dy;
+    size_t n, m;
+    assert(!li_nat_is_zero(y));
+    if (!x.big && !y.big) {
+        if (q) {
+            *q = x;
+            q->data = x.data / y.data;
+        }
+        if (r) {
+            *r = x;
+            r->data = x.data % y.data;
+        }
+        return;
+    }
+    if (li_nat_cmp(x, y) == LI_CMP_LT) {
+        if (q)
+            *q = li_nat_with_int(0);
+        if (r)
+            *r = x;
+        return;
+    }
+    n = li_nat_digits(x, bx, &dx);
+    m = li_nat_digits(y, by, &dy);
+    if (q)
+        dq = li_digits_new(n - m + 1);
+    if (r)
+        dr = li_digits_new(m);
+    li_digits_divmod(dx, n, dy, m, dq, dr);
+    if (q)
+        *q = li_nat_make(dq, n - m + 1);
+    if (r)
+        *r = li_nat_make(dr, m);
 }
 
 extern li_nat_t li_nat_div(li_nat_t x, li_nat_t y)
 {
-    assert(y.data);
-    x.data /= y.data;
+    li_nat_divmod(x, y, &x, NULL);
     return x;
 }
 
 extern li_nat_t li_nat_mod(li_nat_t x, li_nat_t y)
 {
-    assert(y.data);
-    x.data %= y.data;
+    li_nat_divmod(x, y, NULL, &x);
     return x;
 }
 
 extern li_cmp_t li_nat_cmp(li_nat_t x, li_nat_t y)
 {
-    if (x.data < y.data)
-        return LI_CMP_LT;
-    else if (x.data > y.data)
-        return LI_CMP_GT;
-    return LI_CMP_EQ;
+    int c;
+    if (!x.big && !y.big)
+        return x.data < y.data ? LI_CMP_LT : x.data > y.data ? LI_CMP_GT
+            : LI_CMP_EQ;
+    if (!x.big || !y.big)
+        return x.big ? LI_CMP_GT : LI_CMP_LT;
+    c = li_digits_cmp(li_big(x)->digits, li_big(x)->size,
+            li_big(y)->digits, li_big(y)->size);
+    return c < 0 ? LI_CMP_LT : c > 0 ? LI_CMP_GT : LI_CMP_EQ;
+}
+
+/* Binary GCD of two unsigned longs. */
+static unsigned long li_long_gcd(unsigned long x, unsigned long y)
+{
+    unsigned long t;
+    int k;
+    if (!x || !y)
+        return x | y;
+    k = __builtin_ctzl(x | y);
+    x >>= __builtin_ctzl(x);
+    do {
+        y >>= __builtin_ctzl(y);
+        if (x > y) {
+            t = x;
+            x = y;
+            y = t;
+        }
+        y -= x;
+    } while (y);
+    return x << k;
+}
+
+/* Number of trailing zero bits of a, which must not be zero. */
+static size_t li_digits_ctz(const li_digit_t *a)
+{
+    size_t i = 0;
+    while (!a[i])
+        i++;
+    return i * LI_DIGIT_BITS + __builtin_ctz(a[i]);
 }
 
+/* Shifts a[0..n) right by s bits in place and returns its new length. */
+static size_t li_digits_shr(li_digit_t *a, size_t n, size_t s)
+{
+    size_t w = s / LI_DIGIT_BITS, i;
+    int b = s % LI_DIGIT_BITS;
+    if (w >= n)
+        return 0;
+    for (i = 0; i + w < n; i++) {
+        li_ddigit_t t = a[i + w];
+        if (i + w + 1 < n)
+            t |= (li_ddigit_t)a[i + w + 1] << LI_DIGIT_BITS;
+        a[i] = (li_digit_t)(t >> b);
+    }
+    return li_digits_trim(a, n - w);
+}
+
+/* Like li_nat_make, but shifts a[0..n) left by s bits first. */
+static li_nat_t li_nat_make_shl(li_digit_t *a, size_t n, size_t s)
+{
+    size_t w = s / LI_DIGIT_BITS, i;
+    int b = s % LI_DIGIT_BITS;
+    li_digit_t *z;
+    if (!s)
+        return li_nat_make(a, n);
+    z = li_digits_new(n + w + 1);
+    memset(z, 0, (n + w + 1) * sizeof(*z));
+    for (i = 0; i < n; i++) {
+        li_ddigit_t t = (li_ddigit_t)a[i] << b;
+        z[i + w] |= (li_digit_t)t;
+        z[i + w + 1] = (li_digit_t)(t >> LI_DIGIT_BITS);
+    }
+    free(a);
+    return li_nat_make(z, n + w + 1);
+}
+
+static size_t li_nat_size(li_nat_t x)
+{
+    return x.big ? li_big(x)->size : LI_LONG_DIGITS;
+}
+
+/*
+ * Stein's binary algorithm, which gets by with subtractions and shifts.  Each
+ * step only takes off a bit or so, though, so operands of very different
+ * lengths are first brought together with a division.
+ */
 extern li_nat_t li_nat_gcd(li_nat_t x, li_nat_t y)
 {
-    while (!li_nat_is_zero(y)) {
-        li_nat_t z = y;
-        y = li_nat_mod(x, y);
-        x = z;
+    li_digit_t bx[LI_LONG_DIGITS], by[LI_LONG_DIGITS], *u, *v, *t;
+    const li_digit_t *dx, *dy;
+    size_t n, m, k, tz;
+    int c;
+    for (;;) {
+        if (li_nat_cmp(x, y) == LI_CMP_LT) {
+            li_nat_t z = x;
+            x = y;
+            y = z;
+        }
+        if (!x.big) {
+            x.data = li_long_gcd(x.data, y.data);
+            return x;
+        }
+        if (li_nat_is_zero(y))
+            return x;
+        if (li_nat_size(x) <= li_nat_size(y) + 1)
+            break;
+        x = li_nat_mod(x, y);
     }
-    return x;
+    n = li_nat_digits(x, bx, &dx);
+    m = li_nat_digits(y, by, &dy);
+    u = li_digits_new(n);
+    v = li_digits_new(m);
+    memcpy(u, dx, n * sizeof(*u));
+    memcpy(v, dy, m * sizeof(*v));
+    k = li_digits_ctz(u);
+    tz = li_digits_ctz(v);
+    n = li_digits_shr(u, n, k);
+    m = li_digits_shr(v, m, tz);
+    if (tz < k)
+        k = tz;
+    /* Both are odd from here on, so their difference is even. */
+    while ((c = li_digits_cmp(u, n, v, m))) {
+        if (c < 0) {
+            t = u, u = v, v = t;
+            tz = n, n = m, m = tz;
+        }
+        li_digits_sub_from(u, n, v, m);
+        n = li_digits_trim(u, n);
+        n = li_digits_shr(u, n, li_digits_ctz(u));
+    }
+    free(v);
+    return li_nat_make_shl(u, n, k);
 }
@@ -2,15 +2,14 @@
 #include "li_lib.h"
 #include "li_num.h"
 
+#include <errno.h>
 #include <math.h>
+#include <string.h>
 
-#define are_exact(x, y) ((x)->exact && (y)->exact)
+#define are_exact(x, y) (li_num_is_exact(x) && li_num_is_exact(y))
 
-#define CACHE_SIZE 256
-
-static li_num_t *cache;
-static li_num_t *li_zero;
-static li_num_t *li_one;
+#define li_zero ((li_num_t *)li_fixnum(0))
+#define li_one ((li_num_t *)li_fixnum(1))
 
 union part {
     li_rat_t exact;
@@ -23,22 +22,43 @@ struct li_num_t {
     const union part real;
 };
 
+/* The exact value of x, which may be a fixnum. */
+static li_rat_t li_num_rat(li_num_t *x)
+{
+    li_rat_t y;
+    if (!li_is_fixnum(x))
+        return x->real.exact;
+    y.neg = li_fixnum_value(x) < 0;
+    y.num = li_nat_with_int(li_fixnum_value(x));
+    y.den = li_nat_with_int(1);
+    return y;
+}
+
+static void mark(li_num_t *num)
+{
+    if (num->exact) {
+        li_nat_mark(num->real.exact.num);
+        li_nat_mark(num->real.exact.den);
+    }
+}
+
 static void write(li_num_t *num, li_port_t *port)
 {
-    if (!li_num_is_exact(num))
-        li_port_printf(port, "%f", li_num_to_dec(num));
-    else if (li_num_is_integer(num))
-        li_port_printf(port, "%d", li_num_to_int(num));
-    else
-        li_port_printf(port, "%s%ld/%ld",
-                li_rat_is_negative(num->real.exact) ? "-" : "",
-                li_nat_to_int(li_rat_num(num->real.exact)),
-                li_nat_to_int(li_rat_den(num->real.exact)));
+    char buf[64], *s = buf;
+    size_t n = li_num_to_chars(num, buf, sizeof(buf));
+    if (n >= sizeof(buf)) {
+        s = li_allocate(NULL, n + 1, sizeof(char));
+        li_num_to_chars(num, s, n + 1);
+    }
+    li_port_printf(port, "%s", s);
+    if (s != buf)
+        free(s);
 }
 
 const li_type_t li_type_number = {
     .name = "number",
     .size = sizeof(li_num_t),
+    .mark = (li_mark_f *)mark,
     .write = (li_write_f *)write,
     .compare = (li_cmp_f *)li_num_cmp,
 };
@@ -56,8 +76,13 @@ static li_num_t *make_num(li_bool_t exactness, li_rat_t *exact, li_dec_t *inexac
 
 static li_num_t *make_exact(li_rat_t exact)
 {
-    if (!exact.neg && exact.num.data < CACHE_SIZE && exact.den.data == 1)
-        return &cache[exact.num.data];
+    if (li_rat_is_integer(exact)) {
+        exact = li_rat_norm(exact);
+        if (!exact.num.big
+                && exact.num.data <= (unsigned long)LI_FIXNUM_MAX + exact.neg)
+            return (li_num_t *)li_fixnum(exact.neg
+                    ? -(long)exact.num.data : (long)exact.num.data);
+    }
     return make_num(LI_TRUE, &exact, NULL);
 }
 
@@ -68,17 +93,54 @@ static li_num_t *make_inexact(li_dec_t inexact)
 
 extern li_bool_t li_num_is_integer(li_num_t *x)
 {
+    if (li_is_fixnum(x))
+        return LI_TRUE;
     if (li_num_is_exact(x))
-        return !li_rat_is_integer(x->real.exact);
+        return li_rat_is_integer(x->real.exact);
     return x->real.inexact == floor(x->real.inexact);
 }
 
+static unsigned long hash_long(long x)
+{
+    return li_hash_bytes(&x, sizeof(x));
+}
+
+/*
+ * Integers hash as longs whatever their representation or exactness, and
+ * other exact numbers are brought to lowest terms first, so that the numbers
+ * li_num_cmp finds exactly equal hash the same.  Inexact numbers only within
+ * its tolerance of each other generally do not.
+ */
+extern unsigned long li_num_hash(li_num_t *x)
+{
+    li_dec_t d;
+    if (li_is_fixnum(x))
+        return hash_long(li_fixnum_value(x));
+    if (li_num_is_exact(x)) {
+        li_rat_t y = li_rat_norm(x->real.exact);
+        li_nat_t num = li_rat_num(y);
+        if (li_rat_is_integer(y) && !num.big && num.data <= LONG_MAX)
+            return hash_long(li_rat_is_negative(y)
+                    ? -(long)num.data : (long)num.data);
+        d = li_rat_to_dec(y);
+    } else {
+        d = x->real.inexact;
+    }
+    if (d == floor(d) && fabs(d) < LONG_MAX)
+        return hash_long((long)d);
+    return li_hash_bytes(&d, sizeof(d));
+}
+
 extern li_cmp_t li_num_cmp(li_num_t *x, li_num_t *y)
 {
     static const li_dec_t epsilon = 1.0 / (1 << 22);
     li_dec_t z;
+    if (li_is_fixnum(x) && li_is_fixnum(y)) {
+        long a = li_fixnum_value(x), b = li_fixnum_value(y);
+        return a < b ? LI_CMP_LT : a > b ? LI_CMP_GT : LI_CMP_EQ;
+    }
     if (are_exact(x, y))
-        return li_rat_cmp(x->real.exact, y->real.exact);
+        return li_rat_cmp(li_num_rat(x), li_num_rat(y));
     z = li_num_to_dec(x) - li_num_to_dec(y);
     if (fabs(z) < epsilon)
         return LI_CMP_EQ;
@@ -87,8 +149,8 @@ extern li_cmp_t li_num_cmp(li_num_t *x, li_num_t *y)
 
 static li_num_t *li_num_exact_to_inexact(li_num_t *x)
 {
-    if (x->exact)
-        return make_inexact(li_rat_to_dec(x->real.exact));
+    if (li_num_is_exact(x))
+        return make_inexact(li_rat_to_dec(li_num_rat(x)));
     return x;
 }
 
@@ -97,7 +159,7 @@ extern li_num_t *li_num_max(li_num_t *x, li_num_t *y)
     li_bool_t exact = are_exact(x, y);
     if (li_num_cmp(x, y) == LI_CMP_LT)
         x = y;
-    if (!exact && x->exact)
+    if (!exact && li_num_is_exact(x))
         return li_num_exact_to_inexact(x);
     return x;
 }
@@ -107,7 +169,7 @@ extern li_num_t *li_num_min(li_num_t *x, li_num_t *y)
     li_bool_t exact = are_exact(x, y);
     if (li_num_cmp(x, y) == LI_CMP_GT)
         x = y;
-    if (!exact && x->exact)
+    if (!exact && li_num_is_exact(x))
         return li_num_exact_to_inexact(x);
     return x;
 }
@@ -117,22 +179,39 @@ extern li_num_t *li_num_with_dec(li_dec_t x)
     return make_inexact(x);
 }
 
+/* Where to go on writing once len characters went into s, of size n. */
+#define li_chars_at(s, n, len)  ((len) < (n) ? (s) + (len) : NULL)
+#define li_chars_left(n, len)   ((len) < (n) ? (n) - (len) : 0)
+
 extern size_t li_num_to_chars(li_num_t *x, char *s, size_t n)
 {
-    if (!li_num_is_exact(x))
+    li_rat_t q;
+    size_t len;
+    if (li_is_fixnum(x))
+        return snprintf(s, n, "%ld", li_fixnum_value(x));
+    else if (!li_num_is_exact(x))
         return snprintf(s, n, "%f", li_num_to_dec(x));
-    else if (li_num_is_integer(x))
-        return snprintf(s, n, "%d", li_num_to_int(x));
-    else
-        return snprintf(s, n, "%s%ld/%ld",
-                li_rat_is_negative(x->real.exact) ? "-" : "",
-                li_nat_to_int(li_rat_num(x->real.exact)),
-                li_nat_to_int(li_rat_den(x->real.exact)));
+    q = li_rat_norm(x->real.exact);
+    len = snprintf(s, n, "%s", li_rat_is_negative(q) ? "-" : "");
+    len += li_nat_to_chars(li_rat_num(q), li_chars_at(s, n, len),
+            li_chars_left(n, len));
+    if (li_rat_is_integer(q))
+        return len;
+    len += snprintf(li_chars_at(s, n, len), li_chars_left(n, len), "/");
+    return len + li_nat_to_chars(li_rat_den(q), li_chars_at(s, n, len),
+            li_chars_left(n, len));
 }
 
 extern li_num_t *li_num_with_int(int x)
 {
-    return make_exact(li_rat_with_int(x));
+    return li_num_with_long(x);
+}
+
+extern li_num_t *li_num_with_long(long x)
+{
+    if (x < LI_FIXNUM_MIN || x > LI_FIXNUM_MAX)
+        return make_exact(li_rat_with_int(x));
+    return (li_num_t *)li_fixnum(x);
 }
 
 extern li_num_t *li_num_with_rat(li_rat_t x)
@@ -140,61 +219,126 @@ extern li_num_t *li_num_with_rat(li_rat_t x)
     return make_exact(x);
 }
 
+/*
+ * Integers and fractions are read exactly, anything else goes through a
+ * double.
+ */
 extern li_num_t *li_num_with_chars(const char *s, int radix)
 {
+    char *end;
+    long n;
+    li_rat_t q;
     li_dec_t x;
     if (radix != 10)
         li_error_fmt("only radix of 10 is supported");
+    errno = 0;
+    n = strtol(s, &end, 10);
+    if (end != s && !*end && !errno)
+        return li_num_with_long(n);
+    if (*s && li_rat_read(&q, s) == strlen(s))
+        return li_num_with_rat(q);
     x = li_dec_parse(s);
-    return x == floor(x) ? li_num_with_int(x) : li_num_with_dec(x);
+    if (x == floor(x) && (li_dec_t)LONG_MIN <= x && x < -(li_dec_t)LONG_MIN)
+        return li_num_with_long(x);
+    return li_num_with_dec(x);
 }
 
 extern int li_num_to_int(li_num_t *x)
 {
+    return li_num_to_long(x);
+}
+
+extern long li_num_to_long(li_num_t *x)
+{
+    if (li_is_fixnum(x))
+        return li_fixnum_value(x);
     if (li_num_is_exact(x))
         return li_rat_to_int(x->real.exact);
     return (li_int_t)x->real.inexact;
 }
 
+extern li_bool_t li_num_fits_long(li_num_t *x)
+{
+    li_rat_t q;
+    li_nat_t y;
+    if (li_is_fixnum(x))
+        return LI_TRUE;
+    if (!li_num_is_exact(x))
+        return (li_dec_t)LONG_MIN <= x->real.inexact
+            && x->real.inexact < -(li_dec_t)LONG_MIN;
+    q = x->real.exact;
+    y = li_rat_num(q);
+    if (!li_rat_is_integer(q))
+        y = li_nat_div(y, li_rat_den(q));
+    return !y.big
+        && y.data <= (unsigned long)LONG_MAX + li_rat_is_negative(q);
+}
+
 extern li_dec_t li_num_to_dec(li_num_t *x)
 {
+    if (li_is_fixnum(x))
+        return li_fixnum_value(x);
     if (li_num_is_exact(x))
         return li_rat_to_dec(x->real.exact);
     return x->real.inexact;
 }
 
+/*
+ * Sums and differences of two fixnums cannot overflow a long, only the range
+ * of fixnums.  Products are checked for both.
+ */
+#define li_fixnum_fits(z) (LI_FIXNUM_MIN <= (z) && (z) <= LI_FIXNUM_MAX)
+
 extern li_num_t *li_num_add(li_num_t *x, li_num_t *y)
 {
+    if (li_is_fixnum(x) && li_is_fixnum(y)) {
+        long z = li_fixnum_value(x) + li_fixnum_value(y);
+        if (li_fixnum_fits(z))
+            return (li_num_t *)li_fixnum(z);
+    }
     if (are_exact(x, y))
-        return make_exact(li_rat_add(x->real.exact, y->real.exact));
+        return make_exact(li_rat_add(li_num_rat(x), li_num_rat(y)));
     return make_inexact(li_num_to_dec(x) + li_num_to_dec(y));
 }
 
 extern li_num_t *li_num_sub(li_num_t *x, li_num_t *y)
 {
+    if (li_is_fixnum(x) && li_is_fixnum(y)) {
+        long z = li_fixnum_value(x) - li_fixnum_value(y);
+        if (li_fixnum_fits(z))
+            return (li_num_t *)li_fixnum(z);
+    }
     if (are_exact(x, y))
-        return make_exact(li_rat_sub(x->real.exact, y->real.exact));
+        return make_exact(li_rat_sub(li_num_rat(x), li_num_rat(y)));
     return make_inexact(li_num_to_dec(x) - li_num_to_dec(y));
 }
 
 extern li_num_t *li_num_mul(li_num_t *x, li_num_t *y)
 {
+    long z;
+    if (li_is_fixnum(x) && li_is_fixnum(y)
+            && !__builtin_mul_overflow(li_fixnum_value(x), li_fixnum_value(y),
+                &z)
+            && li_fixnum_fits(z))
+        return (li_num_t *)li_fixnum(z);
     if (are_exact(x, y))
-        return make_exact(li_rat_mul(x->real.exact, y->real.exact));
+        return make_exact(li_rat_mul(li_num_rat(x), li_num_rat(y)));
     return make_inexact(li_num_to_dec(x) * li_num_to_dec(y));
 }
 
 extern li_num_t *li_num_div(li_num_t *x, li_num_t *y)
 {
     if (are_exact(x, y))
-        return make_exact(li_rat_div(x->real.exact, y->real.exact));
+        return make_exact(li_rat_div(li_num_rat(x), li_num_rat(y)));
     return make_inexact(li_num_to_dec(x) / li_num_to_dec(y));
 }
 
 extern li_num_t *li_num_neg(li_num_t *x)
 {
+    if (li_is_fixnum(x) && li_fixnum_value(x) != LI_FIXNUM_MIN)
+        return (li_num_t *)li_fixnum(-li_fixnum_value(x));
     if (li_num_is_exact(x))
-        return make_exact(li_rat_neg(x->real.exact));
+        return make_exact(li_rat_neg(li_num_rat(x)));
     return make_inexact(-x->real.inexact);
 }
 
@@ -266,16 +410,26 @@ static li_object *p_is_negative(li_object *args) {
     return li_boolean(li_num_is_negative(num));
 }
 
+static li_bool_t li_num_is_odd(li_num_t *x)
+{
+    li_assert_integer((li_object *)x);
+    if (li_is_fixnum(x))
+        return li_fixnum_value(x) % 2 != 0;
+    if (li_num_is_exact(x))
+        return li_nat_is_odd(li_rat_num(x->real.exact));
+    return fmod(x->real.inexact, 2) != 0;
+}
+
 static li_object *p_is_odd(li_object *args) {
-    li_int_t x;
-    li_parse_args(args, "I", &x);
-    return li_boolean(x % 2 != 0);
+    li_num_t *x;
+    li_parse_args(args, "n", &x);
+    return li_boolean(li_num_is_odd(x));
 }
 
 static li_object *p_is_even(li_object *args) {
-    li_int_t x;
-    li_parse_args(args, "I", &x);
-    return li_boolean(x % 2 == 0);
+    li_num_t *x;
+    li_parse_args(args, "n", &x);
+    return li_boolean(!li_num_is_odd(x));
 }
 
 static li_object *p_max(li_object *args) {
@@ -360,31 +514,58 @@ static li_object *p_abs(li_object *args) {
     return (li_object *)li_num_abs(x);
 }
 
-static li_object *p_quotient(li_object *args) {
-    li_int_t x, y;
-    li_parse_args(args, "II", &x, &y);
-    if (y == 0)
+/*
+ * Divides the integer x by y, truncating, and stores the quotient in q and the
+ * remainder, which has the sign of x, in r, either of which may be NULL.
+ */
+static void li_num_divide(li_num_t *x, li_num_t *y, li_num_t **q,
+        li_num_t **r)
+{
+    li_rat_t a, b;
+    li_assert_integer((li_object *)x);
+    li_assert_integer((li_object *)y);
+    if (li_num_is_zero(y))
         li_error_fmt("arg2 must be non-zero");
-    return (li_object *)li_num_with_int(x / y);
+    if (!are_exact(x, y) || (li_is_fixnum(x) && li_is_fixnum(y))) {
+        li_int_t i = li_num_to_long(x), j = li_num_to_long(y);
+        if (q)
+            *q = li_num_with_long(i / j);
+        if (r)
+            *r = li_num_with_long(i % j);
+        return;
+    }
+    a = li_num_rat(x);
+    b = li_num_rat(y);
+    if (q)
+        *q = make_exact(li_rat_make(li_rat_is_negative(a)
+                    != li_rat_is_negative(b), li_nat_div(a.num, b.num),
+                    li_nat_with_int(1)));
+    if (r)
+        *r = make_exact(li_rat_make(li_rat_is_negative(a),
+                    li_nat_mod(a.num, b.num), li_nat_with_int(1)));
+}
+
+static li_object *p_quotient(li_object *args) {
+    li_num_t *x, *y;
+    li_parse_args(args, "nn", &x, &y);
+    li_num_divide(x, y, &x, NULL);
+    return (li_object *)x;
 }
 
 static li_object *p_remainder(li_object *args) {
-    li_int_t x, y;
-    li_parse_args(args, "II", &x, &y);
-    if (y == 0)
-        li_error_fmt("arg2 must be non-zero");
-    return (li_object *)li_num_with_int(x % y);
+    li_num_t *x, *y;
+    li_parse_args(args, "nn", &x, &y);
+    li_num_divide(x, y, NULL, &x);
+    return (li_object *)x;
 }
 
 static li_object *p_modulo(li_object *args) {
-    li_int_t x, y, z;
-    li_parse_args(args, "II", &x, &y);
-    if (y == 0)
-        li_error_fmt("arg2 must be non-zero");
-    z = x % y;
-    if (z * y < 0)
-        z += y;
-    return (li_object *)li_num_with_int(z);
+    li_num_t *x, *y, *z;
+    li_parse_args(args, "nn", &x, &y);
+    li_num_divide(x, y, NULL, &z);
+    if (!li_num_is_zero(z) && li_num_is_negative(z) != li_num_is_negative(y))
+        z = li_num_add(z, y);
+    return (li_object *)z;
 }
 
 /* TODO: extern this */
@@ -398,50 +579,94 @@ static li_int_t li_int_gcd(li_int_t x, li_int_t y)
     return labs(x);
 }
 
-/* TODO: extern this */
-static li_int_t li_int_lcm(li_int_t a, li_int_t b)
+/* The absolute value of the exact integer x. */
+static li_nat_t li_num_magnitude(li_num_t *x)
 {
-    return labs(a * b) / li_int_gcd(a, b);
+    return li_rat_num(li_rat_norm(li_num_rat(x)));
+}
+
+/*
+ * The greatest common divisor of the integers x and y, which is never
+ * negative.  Bignums go to li_nat_gcd, and inexact integers are worked on as
+ * doubles.
+ */
+static li_num_t *li_num_gcd(li_num_t *x, li_num_t *y)
+{
+    li_dec_t a, b, c;
+    li_assert_integer((li_object *)x);
+    li_assert_integer((li_object *)y);
+    if (li_is_fixnum(x) && li_is_fixnum(y))
+        return li_num_with_long(li_int_gcd(li_fixnum_value(x),
+                    li_fixnum_value(y)));
+    if (are_exact(x, y))
+        return make_exact(li_rat_with_nat(li_nat_gcd(li_num_magnitude(x),
+                        li_num_magnitude(y))));
+    a = fabs(li_num_to_dec(x));
+    b = fabs(li_num_to_dec(y));
+    while (b) {
+        c = fmod(a, b);
+        a = b;
+        b = c;
+    }
+    return make_inexact(a);
+}
+
+/* The least common multiple of the integers x and y, never negative. */
+static li_num_t *li_num_lcm(li_num_t *x, li_num_t *y)
+{
+    li_num_t *z = li_num_gcd(x, y);
+    if (li_num_is_zero(z))
+        return z;
+    z = li_num_mul(li_num_div(x, z), y);
+    return li_num_abs(z);
 }
 
 static li_object *p_gcd(li_object *args) {
-    li_int_t a, b; /* TODO: support li_num_t */
+    li_num_t *x, *y;
     if (!args)
         return (li_object *)li_zero;
-    li_parse_args(args, "I.", &a, &args);
+    li_parse_args(args, "n.", &x, &args);
+    x = li_num_abs(x);
     while (args) {
-        li_parse_args(args, "I.", &b, &args);
-        a = li_int_gcd(a, b);
+        li_parse_args(args, "n.", &y, &args);
+        x = li_num_gcd(x, y);
     }
-    return (li_object *)li_num_with_int(a);
+    li_assert_integer((li_object *)x);
+    return (li_object *)x;
 }
 
 static li_object *p_lcm(li_object *args) {
-    li_int_t a, b; /* TODO: support li_num_t */
+    li_num_t *x, *y;
     if (!args)
         return (li_object *)li_one;
-    li_parse_args(args, "I.", &a, &args);
+    li_parse_args(args, "n.", &x, &args);
+    x = li_num_abs(x);
     while (args) {
-        li_parse_args(args, "I.", &b, &args);
-        a = li_int_lcm(a, b);
+        li_parse_args(args, "n.", &y, &args);
+        x = li_num_lcm(x, y);
     }
-    return (li_object *)li_num_with_int(a);
+    li_assert_integer((li_object *)x);
+    return (li_object *)x;
 }
 
 static li_object *p_numerator(li_object *args) {
     li_num_t *q;
+    li_rat_t x;
     li_parse_args(args, "n", &q);
-    if (!q->exact)
+    if (!li_num_is_exact(q))
         li_error_fmt("not exact: ~a", args); /* TODO: support inexact numbers */
-    return (li_object *)make_exact(li_rat_with_nat(q->real.exact.num));
+    x = li_rat_norm(li_num_rat(q));
+    return (li_object *)make_exact(li_rat_with_nat(x.num));
 }
 
 static li_object *p_denominator(li_object *args) {
     li_num_t *q;
+    li_rat_t x;
     li_parse_args(args, "n", &q);
-    if (!q->exact)
+    if (!li_num_is_exact(q))
         li_error_fmt("not exact: ~a", args); /* TODO: support inexact numbers */
-    return (li_object *)make_exact(li_rat_with_nat(q->real.exact.den));
+    x = li_rat_norm(li_num_rat(q));
+    return (li_object *)make_exact(li_rat_with_nat(x.den));
 }
 
 static li_object *p_floor(li_object *args) {
@@ -547,11 +772,20 @@ static li_object *p_inexact(li_object *args) {
 }
 
 static li_object *p_number_to_string(li_object *args) {
-    static char buf[BUFSIZ];
+    char buf[64], *s = buf;
     li_num_t *z;
+    li_str_t *str;
+    size_t n;
     li_parse_args(args, "n", &z);
-    li_num_to_chars(z, buf, sizeof(buf));
-    return (li_object *)li_string_make(buf);
+    n = li_num_to_chars(z, buf, sizeof(buf));
+    if (n >= sizeof(buf)) {
+        s = li_allocate(NULL, n + 1, sizeof(char));
+        li_num_to_chars(z, s, n + 1);
+    }
+    str = li_string_make(s);
+    if (s != buf)
+        free(s);
+    return (li_object *)str;
 }
 
 static li_object *p_string_to_number(li_object *args) {
@@ -617,266 +851,3 @@ extern void li_define_number_functions(li_env_t *env)
     lilib_defproc(env, "number->string", p_number_to_string);
     lilib_defproc(env, "string->number", p_string_to_number);
 }
-
-static li_num_t _cache[CACHE_SIZE] = {
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=0}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=1}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=2}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=3}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=4}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=5}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=6}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=7}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=8}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=9}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=10}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=11}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=12}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=13}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=14}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=15}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=16}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=17}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=18}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=19}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=20}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=21}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=22}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=23}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=24}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=25}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=26}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=27}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=28}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=29}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=30}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=31}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=32}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=33}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=34}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=35}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=36}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=37}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=38}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=39}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=40}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=41}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=42}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=43}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=44}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=45}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=46}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=47}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=48}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=49}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=50}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=51}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=52}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=53}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=54}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=55}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=56}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=57}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=58}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=59}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=60}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=61}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=62}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=63}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=64}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=65}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=66}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=67}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=68}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=69}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=70}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=71}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=72}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=73}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=74}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=75}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=76}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=77}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=78}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=79}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=80}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=81}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=82}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=83}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=84}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=85}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=86}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=87}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=88}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=89}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=90}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=91}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=92}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=93}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=94}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=95}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=96}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=97}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=98}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=99}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=100}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=101}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=102}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=103}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=104}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=105}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=106}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=107}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=108}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=109}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=110}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=111}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=112}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=113}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=114}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=115}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=116}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=117}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=118}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=119}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=120}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=121}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=122}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=123}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=124}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=125}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=126}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=127}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=128}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=129}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=130}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=131}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=132}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=133}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=134}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=135}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=136}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=137}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=138}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=139}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=140}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=141}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=142}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=143}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=144}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=145}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=146}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=147}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=148}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=149}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=150}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=151}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=152}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=153}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=154}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=155}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=156}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=157}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=158}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=159}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=160}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=161}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=162}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=163}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=164}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=165}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=166}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=167}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=168}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=169}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=170}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=171}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=172}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=173}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=174}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=175}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=176}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=177}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=178}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=179}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=180}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=181}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=182}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=183}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=184}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=185}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=186}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=187}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=188}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=189}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=190}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=191}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=192}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=193}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=194}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=195}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=196}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=197}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=198}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=199}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=200}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=201}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=202}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=203}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=204}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=205}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=206}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=207}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=208}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=209}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=210}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=211}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=212}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=213}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=214}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=215}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=216}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=217}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=218}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=219}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=220}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=221}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=222}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=223}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=224}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=225}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=226}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=227}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=228}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=229}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=230}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=231}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=232}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=233}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=234}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=235}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=236}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=237}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=238}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=239}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=240}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=241}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=242}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=243}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=244}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=245}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=246}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=247}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=248}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=249}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=250}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=251}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=252}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=253}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=254}, .den={.data=1}}}},
-    {.type=&li_type_number, .exact=1, .real={.exact={.num={.data=255}, .den={.data=1}}}},
-};
-
-static li_num_t *cache = _cache;
-static li_num_t *li_zero = &_cache[0];
-static li_num_t *li_one = &_cache[1];
@@ -1,4 +1,5 @@
 #include "li.h"
+#include "li_gc.h"
 #include "li_lib.h"
 
 extern li_object *li_car(li_object *obj)
@@ -13,6 +14,18 @@ extern li_object *li_cdr(li_object *obj)
     return ((li_pair_t *)(obj))->cdr;
 }
 
+extern li_object *li_set_car(li_object *pair, li_object *obj)
+{
+    li_gc_write_barrier(pair, ((li_pair_t *)pair)->car);
+    return ((li_pair_t *)pair)->car = obj;
+}
+
+extern li_object *li_set_cdr(li_object *pair, li_object *obj)
+{
+    li_gc_write_barrier(pair, ((li_pair_t *)pair)->cdr);
+    return ((li_pair_t *)pair)->cdr = obj;
+}
+
 static void pair_mark(li_object *obj)
 {
     li_mark(li_car(obj));
@@ -28,7 +41,7 @@ static void pair_write(li_object *obj, li_port_t *port)
         iter = li_cdr(iter);
         if (iter)
             li_port_printf(port, " ");
-    } while (li_is_pair(iter) && !li_is_locked(iter));
+    } while (li_is_pair(iter));
     if (iter) {
         li_port_printf(port, ". ");
         li_port_write(port, iter);
@@ -56,6 +69,7 @@ static void pair_set(li_object *lst, int k, li_object *obj)
 
 const li_type_t li_type_pair = {
     .name = "pair",
+    .size = sizeof(li_pair_t),
     .mark = pair_mark,
     .write = pair_write,
     .length = li_length,
@@ -65,15 +79,152 @@ const li_type_t li_type_pair = {
 
 extern li_pair_t *li_pair(li_object *car, li_object *cdr)
 {
-    li_pair_t *obj = li_allocate(NULL, 1, sizeof(*obj));
-    li_object_init((li_object *)obj, &li_type_pair);
+    li_pair_t *obj = (li_pair_t *)li_create(&li_type_pair);
     obj->car = car;
     obj->cdr = cdr;
-    obj->filename = NULL;
-    obj->lineno = 0;
     return obj;
 }
 
+/*
+ * Source locations of the pairs read from files.  Few pairs have one, so they
+ * are kept in a hash table keyed by address, with linear probing, rather than
+ * in every pair.  The table holds on to its pairs weakly: the collector
+ * removes the ones which die.  Since the pairs read since the last collection
+ * are listed apart, a minor collection need not look at the others.
+ */
+
+typedef struct {
+    li_object *pair;
+    const char *filename;
+    int lineno;
+} li_location_t;
+
+static struct {
+    li_location_t *table;
+    size_t size;
+    size_t cap;
+    li_object **young;
+    size_t num_young;
+    size_t cap_young;
+} _locations = { NULL, 0, 0, NULL, 0, 0 };
+
+static size_t li_location_hash(li_object *pair)
+{
+    size_t h = (size_t)pair / sizeof(li_pair_t);
+    return (h * 2654435761u) & (_locations.cap - 1);
+}
+
+static li_location_t *li_location_find(li_object *pair)
+{
+    size_t i;
+    if (!_locations.size)
+        return NULL;
+    for (i = li_location_hash(pair); _locations.table[i].pair;
+            i = (i + 1) & (_locations.cap - 1))
+        if (_locations.table[i].pair == pair)
+            return &_locations.table[i];
+    return NULL;
+}
+
+static void li_location_insert(li_object *pair, const char *filename,
+        int lineno)
+{
+    size_t i;
+    for (i = li_location_hash(pair); _locations.table[i].pair
+            && _locations.table[i].pair != pair;
+            i = (i + 1) & (_locations.cap - 1))
+        ;
+    if (!_locations.table[i].pair)
+        _locations.size++;
+    _locations.table[i].pair = pair;
+    _locations.table[i].filename = filename;
+    _locations.table[i].lineno = lineno;
+}
+
+static void li_location_resize(size_t cap)
+{
+    li_location_t *table = _locations.table;
+    size_t old_cap = _locations.cap, i;
+    _locations.table = li_allocate(NULL, cap, sizeof(*_locations.table));
+    _locations.cap = cap;
+    _locations.size = 0;
+    for (i = 0; i < old_cap; i++)
+        if (table[i].pair)
+            li_location_insert(table[i].pair, table[i].filename,
+                    table[i].lineno);
+    free(table);
+}
+
+/* Empties the slot of loc, moving back the entries which probed past it. */
+static void li_location_remove(li_location_t *loc)
+{
+    size_t mask = _locations.cap - 1, i = loc - _locations.table, j = i, k;
+    for (;;) {
+        j = (j + 1) & mask;
+        if (!_locations.table[j].pair)
+            break;
+        k = li_location_hash(_locations.table[j].pair);
+        if (((j - k) & mask) >= ((j - i) & mask)) {
+            _locations.table[i] = _locations.table[j];
+            i = j;
+        }
+    }
+    _locations.table[i].pair = NULL;
+    _locations.size--;
+}
+
+extern void li_pair_set_location(li_object *pair, const char *filename,
+        int lineno)
+{
+    if (2 * (_locations.size + 1) > _locations.cap)
+        li_location_resize(_locations.cap ? 2 * _locations.cap : 256);
+    if (_locations.num_young == _locations.cap_young) {
+        _locations.cap_young = _locations.cap_young
+            ? LI_INC_CAP(_locations.cap_young) : 256;
+        _locations.young = li_reallocate(_locations.young,
+                _locations.num_young, _locations.cap_young,
+                sizeof(*_locations.young));
+    }
+    _locations.young[_locations.num_young++] = pair;
+    li_location_insert(pair, filename, lineno);
+}
+
+extern li_bool_t li_pair_location(li_object *pair, const char **filename,
+        int *lineno)
+{
+    li_location_t *loc = li_location_find(pair);
+    if (!loc)
+        return LI_FALSE;
+    *filename = loc->filename;
+    *lineno = loc->lineno;
+    return LI_TRUE;
+}
+
+extern void li_pair_locations_sweep(li_bool_t minor)
+{
+    size_t i, n;
+    if (minor || li_heap_region_open()) {
+        for (i = n = 0; i < _locations.num_young; i++) {
+            li_object *pair = _locations.young[i];
+            li_location_t *loc;
+            if (li_heap_live(pair, minor))
+                _locations.young[n++] = pair;
+            else if ((loc = li_location_find(pair)))
+                li_location_remove(loc);
+        }
+    } else {
+        for (i = 0; i < _locations.cap; i++) {
+            li_location_t *loc = &_locations.table[i];
+            /* Removing an entry may move the next one back into this slot. */
+            while (loc->pair && !li_heap_live(loc->pair, minor))
+                li_location_remove(loc);
+        }
+        n = 0;
+    }
+    /* The survivors of a region are young still, those of a collection old. */
+    _locations.num_young = li_heap_region_open() ? n : 0;
+}
+
 extern int li_length(li_object *obj)
 {
     int k;
@@ -273,9 +424,12 @@ static li_object *p_append(li_object *args) {
 static li_object *p_filter(li_object *args) {
     li_proc_obj_t *proc;
     li_object *iter, *head, *tail, *temp;
+    int sp;
     li_parse_args(args, "ol", &proc, &iter);
     li_assert_procedure((li_object *)proc); /* XXX */
     head = temp = tail = NULL;
+    sp = li_gc_push_root(&head);
+    li_gc_push_root(&temp);
     while (iter) {
         if (temp)
             li_set_car(temp, li_car(iter));
@@ -287,6 +441,7 @@ static li_object *p_filter(li_object *args) {
         }
         iter = li_cdr(iter);
     }
+    li_gc_pop_roots(sp);
     return head;
 }
 
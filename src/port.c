@@ -1,6 +1,7 @@
 #include "li.h"
 #include "li_lib.h"
 
+#include <errno.h>
 #include <stdarg.h>
 #include <string.h>
 #include <unistd.h>
@@ -57,8 +58,7 @@ li_port_t *li_port_stderr = &port_std[2];
 
 static li_port_t *li_port_new(void)
 {
-    li_port_t *port = li_allocate(NULL, 1, sizeof(*port));
-    li_object_init((li_object *)port, &li_type_port);
+    li_port_t *port = (li_port_t *)li_create(&li_type_port);
     port->fp = NULL;
     port->fd = -1;
     port->flags = 0;
@@ -66,11 +66,30 @@ static li_port_t *li_port_new(void)
     return port;
 }
 
+/*
+ * Opens a file, trying again after a full collection if the process ran out
+ * of file descriptors.  The collection may run here, so filename is protected
+ * meanwhile and the port is only created once the file is open.
+ */
+static FILE *li_port_fopen(li_str_t *filename, const char *mode)
+{
+    FILE *fp;
+    li_gc_protect((li_object *)filename);
+    if (!(fp = fopen(li_string_bytes(filename), mode))
+            && li_gc_reclaim_fds(errno))
+        fp = fopen(li_string_bytes(filename), mode);
+    li_gc_unprotect((li_object *)filename);
+    return fp;
+}
+
 extern li_port_t *li_port_open_input_file(li_str_t *filename)
 {
-    li_port_t *port = li_port_new();
-    if (!(port->fp = fopen(li_string_bytes(filename), "r")))
+    li_port_t *port;
+    FILE *fp;
+    if (!(fp = li_port_fopen(filename, "r")))
         li_error_fmt("could not open input file: ~a", filename);
+    port = li_port_new();
+    port->fp = fp;
     port->flags = IO_INPUT | IO_FILE;
     port->name = filename;
     return port;
@@ -78,9 +97,12 @@ extern li_port_t *li_port_open_input_file(li_str_t *filename)
 
 extern li_port_t *li_port_open_output_file(li_str_t *filename)
 {
-    li_port_t *port = li_port_new();
-    if (!(port->fp = fopen(li_string_bytes(filename), "w")))
+    li_port_t *port;
+    FILE *fp;
+    if (!(fp = li_port_fopen(filename, "w")))
         li_error_fmt("could not open output file: ~a", filename);
+    port = li_port_new();
+    port->fp = fp;
     port->flags = IO_OUTPUT | IO_FILE;
     port->name = filename;
     return port;
@@ -98,7 +120,7 @@ extern void li_port_write(li_port_t *port, li_object *obj)
     } else if (li_type(obj)->write) {
         li_type(obj)->write(obj, port);
     } else if (li_type(obj)->name) {
-        li_port_printf(port, "#[%s @%p]", obj->type->name, (void *)obj);
+        li_port_printf(port, "#[%s @%p]", li_type(obj)->name, (void *)obj);
     } else {
         li_port_printf(port, "#[unknown-type]");
     }
@@ -151,12 +173,9 @@ static void deinit(li_port_t *port)
 {
     if (port == li_port_stdin
             || port == li_port_stdout
-            || port == li_port_stderr) {
-        li_unlock(port);
+            || port == li_port_stderr)
         return;
-    }
     li_port_close(port);
-    free(port);
 }
 
 static void writer(li_port_t *obj, li_port_t *port)
@@ -166,6 +185,7 @@ static void writer(li_port_t *obj, li_port_t *port)
 
 const li_type_t li_type_port = {
     .name = "port",
+    .size = sizeof(li_port_t),
     .mark = (li_mark_f *)mark,
     .deinit = (li_deinit_f *)deinit,
     .write = (li_write_f *)writer,
@@ -151,6 +151,7 @@ static li_object *p_eval(li_object *args) {
 
 extern void li_define_procedure_functions(li_env_t *env)
 {
+    li_gc_add_root(&new_expr);
     lilib_defproc(env, "procedure?", p_is_procedure);
     lilib_defproc(env, "apply", p_apply);
     lilib_defproc(env, "eval", p_eval);
@@ -158,7 +159,7 @@ extern void li_define_procedure_functions(li_env_t *env)
 }
 
 #define li_is_self_evaluating(expr)  !(!expr || li_is_pair(expr) || li_is_symbol(expr))
-#define quote(expr)         li_cons(li_symbol("quote"), li_cons(expr, NULL))
+#define quote(expr)         li_cons(li_sym_quote, li_cons(expr, NULL))
 
 static li_object *eval_quasiquote(li_object *expr, li_env_t *env);
 static li_object *list_of_values(li_object *exprs, li_env_t *env);
@@ -174,8 +175,12 @@ static li_object *list_of_values(li_object *exprs, li_env_t *env);
 extern li_object *li_apply(li_object *proc, li_object *args) {
     li_object *head = NULL,
               *tail = NULL;
-    if (li_is_primitive_procedure(proc))
-        return li_proc_prim(proc)(args);
+    if (li_is_primitive_procedure(proc)) {
+        int sp = li_gc_push_root(&args);
+        args = li_proc_prim(proc)(args);
+        li_gc_pop_roots(sp);
+        return args;
+    }
     /* make a list of arguments with non-self-evaluating values quoted */
     while (args) {
         li_object *arg;
@@ -222,6 +227,7 @@ static li_object *replace(li_env_t *env, li_object *expr, li_object *stack, li_o
     } else if (li_is_pair(expr)) {
         if (contains(expr, next_expr)) {
             li_object *head = NULL, *tail = NULL;
+            int sp = li_gc_push_root(&head);
             while (expr) {
                 li_object *node = replace(env, li_car(expr), stack, karg);
                 node = li_cons(node, NULL);
@@ -233,6 +239,7 @@ static li_object *replace(li_env_t *env, li_object *expr, li_object *stack, li_o
                     head = tail;
                 expr = li_cdr(expr);
             }
+            li_gc_pop_roots(sp);
             expr = head;
             /* return expr; */
         } else {
@@ -248,6 +255,8 @@ static li_object *unwind(li_object *stack, li_object *karg)
 {
     li_env_t *env;
     li_object *expr;
+    int sp = li_gc_push_root(&stack);
+    li_gc_push_root(&karg);
     (void)print_stack;
     stack = li_list_reverse(stack);
     /* print_stack(stack); */
@@ -255,42 +264,54 @@ static li_object *unwind(li_object *stack, li_object *karg)
     stack = replace(env, expr, li_cdr(stack), karg);
     /* li_port_printf(li_port_stderr, "\t=> "); */
     /* li_print(stack, li_port_stderr); */
+    li_gc_pop_roots(sp);
     return stack;
 }
 
 extern li_object *li_eval(li_object *expr, li_env_t *env)
 {
-    static int num_evals;
+    static int top_sp;
+    li_object *proc = NULL, *args = NULL;
+    /* The caller's expression and environment stay rooted even after a tail
+     * call replaced them, since the caller may still be using them. */
+    li_object *expr0 = expr, *env0 = (li_object *)env;
     int done = 0;
+    int sp = li_gc_push_root(&proc);
+    li_gc_push_root(&args);
+    li_gc_push_root(&expr0);
+    li_gc_push_root(&env0);
     if (!li_stack_trace()) {
-        int ret = setjmp(jb);
+        int ret;
+        top_sp = sp;
+        ret = setjmp(jb);
         if (ret) {
+            /* Drop the roots of the evaluations we jumped out of. */
+            li_gc_pop_roots(top_sp + 4);
+            li_region_abort();
+            proc = args = NULL;
             expr = new_expr;
             new_expr = NULL;
         }
     }
-    if (++num_evals > 100000) {
-        num_evals = 0;
-        li_cleanup(env);
-    }
     while (!li_is_self_evaluating(expr) && !done) {
         li_stack_trace_push(expr, env);
+        li_gc_safe_point();
         if (!expr) {
             li_error_fmt("empty list in source");
         } else if (li_is_symbol(expr)) {
             expr = li_env_lookup(env, (li_sym_t *)expr);
             done = 1;
         } else if (li_is_list(expr)) {
-            li_object *proc = li_car(expr),
-                      *args = li_cdr(expr);
-            if (li_is_eq(proc, li_symbol("quote"))) {
+            proc = li_car(expr);
+            args = li_cdr(expr);
+            if (li_is_eq(proc, li_sym_quote)) {
                 li_parse_args(args, "o", &expr);
                 done = 1;
-            } else if (li_is_eq(proc, li_symbol("quasiquote"))) {
+            } else if (li_is_eq(proc, li_sym_quasiquote)) {
                 li_parse_args(args, "o", &expr);
                 expr = eval_quasiquote(expr, env);
                 done = 1;
-            } else if (li_is_eq(proc, li_symbol("if"))) {
+            } else if (li_is_eq(proc, li_sym_if)) {
                 li_object *test, *cons, *alt = li_false;
                 li_parse_args(args, "oo?o", &test, &cons, &alt);
                 test = li_eval(test, env);
@@ -307,7 +328,7 @@ extern li_object *li_eval(li_object *expr, li_env_t *env)
                     if (expr && !li_cdr(expr))
                         expr = li_car(expr);
                     else if (expr && li_cdr(expr))
-                        expr = li_cons(li_symbol("begin"), expr);
+                        expr = li_cons(li_sym_begin, expr);
                 }
             } else if (li_is_macro(proc)) {
                 if (li_macro_primitive(proc)) {
@@ -315,7 +336,7 @@ extern li_object *li_eval(li_object *expr, li_env_t *env)
                 } else {
                     expr = li_macro_expand((li_macro_t *)proc, expr, env);
                 }
-            } else if (li_is_type(proc, &li_type_continuation)) {
+            } else if (li_is_object_type(proc, &li_type_continuation)) {
                 li_cont_t *c = (li_cont_t *)proc;
                 li_object *arg;
                 li_parse_args(args, "o", &arg);
@@ -334,6 +355,7 @@ extern li_object *li_eval(li_object *expr, li_env_t *env)
         }
         li_stack_trace_pop();
     }
+    li_gc_pop_roots(sp);
     return expr;
 }
 
@@ -367,31 +389,39 @@ static li_object *eval_quasiquote(li_object *expr, li_env_t *env)
 {
     if (!li_is_pair(expr))
         return expr;
-    if (li_is_eq(li_car(expr), li_symbol("unquote")))
+    if (li_is_eq(li_car(expr), li_sym_unquote))
         return li_eval(li_cadr(expr), env);
     if (li_is_pair(li_car(expr))
-            && li_is_eq(li_caar(expr), li_symbol("unquote-splicing"))) {
+            && li_is_eq(li_caar(expr), li_sym_unquote_splicing)) {
         li_object *head, *tail;
+        int sp;
         li_parse_args(li_cdar(expr), "o", &head);
         head = li_eval(head, env);
+        sp = li_gc_push_root(&head);
         tail = eval_quasiquote(li_cdr(expr), env);
+        li_gc_pop_roots(sp);
         if (!head)
             return tail;
         li_list_append(head, tail);
         return head;
+    } else {
+        li_object *car = eval_quasiquote(li_car(expr), env);
+        int sp = li_gc_push_root(&car);
+        expr = li_cons(car, eval_quasiquote(li_cdr(expr), env));
+        li_gc_pop_roots(sp);
+        return expr;
     }
-    return li_cons(
-            eval_quasiquote(li_car(expr), env),
-            eval_quasiquote(li_cdr(expr), env));
 }
 
 static li_object *list_of_values(li_object *args, li_env_t *env)
 {
-    li_object *head = NULL, *tail;
+    li_object *head = NULL, *tail = NULL;
+    int sp = li_gc_push_root(&head);
     while (args) {
         li_object *node = li_cons(li_eval(li_car(args), env), NULL);
         tail = head ? li_set_cdr(tail, node) : (head = node);
         args = li_cdr(args);
     }
+    li_gc_pop_roots(sp);
     return head;
 }
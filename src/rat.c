@@ -3,9 +3,20 @@
 
 #include <assert.h>
 
-static li_rat_t li_rat_norm(li_rat_t x);
+/*
+ * The arithmetic below leaves its results in whatever terms they come out in,
+ * and only brings them to lowest terms once the numerator or denominator no
+ * longer fits in a word, since a long chain of operations on small fractions
+ * is better off with a few more multiplications than with a gcd at every
+ * step.  Whatever looks at the numerator and denominator on their own, such as
+ * printing, has to call li_rat_norm first; comparisons and conversions do not
+ * care.
+ */
 
-static li_rat_t li_rat_norm(li_rat_t x)
+#define li_rat_is_whole(x) \
+    (li_nat_cmp(li_rat_den(x), li_nat_with_int(1)) == LI_CMP_EQ)
+
+extern li_rat_t li_rat_norm(li_rat_t x)
 {
     li_nat_t r;
 
@@ -14,6 +25,8 @@ static li_rat_t li_rat_norm(li_rat_t x)
         x.den = li_nat_with_int(1);
         return x;
     }
+    if (li_rat_is_whole(x))
+        return x;
     r = li_nat_gcd(li_rat_num(x), li_rat_den(x));
     if (li_nat_cmp(r, li_nat_with_int(1)) != LI_CMP_EQ) {
         x.num = li_nat_div(li_rat_num(x), r);
@@ -22,6 +35,13 @@ static li_rat_t li_rat_norm(li_rat_t x)
     return x;
 }
 
+static li_rat_t li_rat_lazy_norm(li_rat_t x)
+{
+    if (li_rat_is_zero(x) || x.num.big || x.den.big)
+        return li_rat_norm(x);
+    return x;
+}
+
 extern li_rat_t li_rat_make(li_bool_t neg, li_nat_t num, li_nat_t den)
 {
     li_rat_t x;
@@ -36,9 +56,9 @@ extern li_rat_t li_rat_with_nat(li_nat_t z)
     return li_rat_make(LI_FALSE, z, li_nat_with_int(1));
 }
 
-extern li_rat_t li_rat_with_int(int x)
+extern li_rat_t li_rat_with_int(li_int_t x)
 {
-    return li_rat_make(x < 0, li_nat_with_int(abs(x)), li_nat_with_int(1));
+    return li_rat_make(x < 0, li_nat_with_int(x), li_nat_with_int(1));
 }
 
 extern li_rat_t li_rat_parse(const char *s)
@@ -52,24 +72,28 @@ extern size_t li_rat_read(li_rat_t *dst, const char *s)
 {
     size_t n = 0;
     li_rat_t x;
+    size_t k;
     x.neg = (s[n] == '-');
     if (x.neg || s[n] == '+')
         n++;
-    n += li_nat_read(&x.num, s+n);
+    if (!(k = li_nat_read(&x.num, s+n)))
+        return 0;
+    n += k;
     if (s[n] == '/') {
-        n++;
-        n += li_nat_read(&x.den, s+n);
+        if (!(k = li_nat_read(&x.den, s+n+1)))
+            return 0;
+        n += k + 1;
     } else {
         x.den = li_nat_with_int(1);
     }
-    if (n)
-        *dst = li_rat_norm(x);
+    *dst = li_rat_norm(x);
     return n;
 }
 
 extern li_bool_t li_rat_is_integer(li_rat_t x)
 {
-    return li_nat_cmp(li_rat_den(x), li_nat_with_int(1));
+    return li_rat_is_whole(x)
+        || li_nat_is_zero(li_nat_mod(li_rat_num(x), li_rat_den(x)));
 }
 
 extern li_bool_t li_rat_is_negative(li_rat_t x)
@@ -99,6 +123,10 @@ extern li_cmp_t li_rat_cmp(li_rat_t x, li_rat_t y)
         return LI_CMP_LT;
     if (!li_rat_is_negative(x) && li_rat_is_negative(y))
         return LI_CMP_GT;
+    if (li_rat_is_whole(x) && li_rat_is_whole(y))
+        return li_rat_is_negative(x)
+            ? li_nat_cmp(li_rat_num(y), li_rat_num(x))
+            : li_nat_cmp(li_rat_num(x), li_rat_num(y));
     if (!li_nat_cmp(li_rat_num(x), li_rat_num(y))
             && !li_nat_cmp(li_rat_den(x), li_rat_den(y)))
         return LI_CMP_EQ;
@@ -119,19 +147,25 @@ extern li_rat_t li_rat_add(li_rat_t x, li_rat_t y)
         return li_rat_sub(x, li_rat_abs(y));
     if (li_rat_is_negative(x) && !li_rat_is_negative(y))
         return li_rat_sub(y, li_rat_abs(x));
+    if (li_rat_is_whole(x) && li_rat_is_whole(y)) {
+        x.num = li_nat_add(li_rat_num(x), li_rat_num(y));
+        return x;
+    }
     x.num = li_nat_add(
             li_nat_mul(li_rat_num(x), li_rat_den(y)),
             li_nat_mul(li_rat_den(x), li_rat_num(y)));
     x.den = li_nat_mul(li_rat_den(x), li_rat_den(y));
-    return li_rat_norm(x);
+    return li_rat_lazy_norm(x);
 }
 
 extern li_rat_t li_rat_mul(li_rat_t x, li_rat_t y)
 {
     x.neg = li_rat_is_negative(x) != li_rat_is_negative(y);
-    x.num = li_nat_mul(x.num, y.num);
-    x.den = li_nat_mul(x.den, y.den);
-    return li_rat_norm(x);
+    x.num = li_nat_mul(li_rat_num(x), li_rat_num(y));
+    if (li_rat_is_whole(x) && li_rat_is_whole(y))
+        return x;
+    x.den = li_nat_mul(li_rat_den(x), li_rat_den(y));
+    return li_rat_lazy_norm(x);
 }
 
 extern li_rat_t li_rat_sub(li_rat_t x, li_rat_t y)
@@ -145,8 +179,13 @@ extern li_rat_t li_rat_sub(li_rat_t x, li_rat_t y)
         return li_rat_add(x, li_rat_neg(y));
     if (li_rat_is_negative(x) && !li_rat_is_negative(y))
         return li_rat_neg(li_rat_add(li_rat_neg(x), y));
-    z0 = li_nat_mul(li_rat_num(x), li_rat_den(y));
-    z1 = li_nat_mul(li_rat_num(y), li_rat_den(x));
+    if (li_rat_is_whole(x) && li_rat_is_whole(y)) {
+        z0 = li_rat_num(x);
+        z1 = li_rat_num(y);
+    } else {
+        z0 = li_nat_mul(li_rat_num(x), li_rat_den(y));
+        z1 = li_nat_mul(li_rat_num(y), li_rat_den(x));
+    }
     if (li_nat_cmp(z0, z1) == LI_CMP_LT) {
         x.neg = !li_rat_is_negative(x);
         x.num = li_nat_sub(z1, z0);
@@ -154,7 +193,7 @@ extern li_rat_t li_rat_sub(li_rat_t x, li_rat_t y)
         x.num = li_nat_sub(z0, z1);
     }
     x.den = li_nat_mul(li_rat_den(x), li_rat_den(y));
-    return li_rat_norm(x);
+    return li_rat_lazy_norm(x);
 }
 
 extern li_rat_t li_rat_div(li_rat_t x, li_rat_t y)
@@ -162,7 +201,7 @@ extern li_rat_t li_rat_div(li_rat_t x, li_rat_t y)
     x.neg = li_rat_is_negative(x) != li_rat_is_negative(y);
     x.num = li_nat_mul(li_rat_num(x), li_rat_den(y));
     x.den = li_nat_mul(li_rat_den(x), li_rat_num(y));
-    return li_rat_norm(x);
+    return li_rat_lazy_norm(x);
 }
 
 extern li_rat_t li_rat_neg(li_rat_t x)
@@ -184,13 +223,17 @@ extern li_dec_t li_rat_to_dec(li_rat_t x)
     return li_rat_is_negative(x) ? -y : y;
 }
 
+/* Truncates x, saturating at LONG_MIN and LONG_MAX. */
 extern li_int_t li_rat_to_int(li_rat_t x)
 {
     li_nat_t y;
-    li_int_t z;
     y = li_rat_num(x);
     if (!li_rat_is_integer(x))
         y = li_nat_div(y, li_rat_den(x));
-    z = li_nat_to_int(y);
-    return li_rat_is_negative(x) ? -z : z;
+    if (!li_rat_is_negative(x))
+        return li_nat_to_int(y);
+    if (li_nat_is_zero(y))
+        return 0;
+    /* -LONG_MIN does not fit in a long, but one less does. */
+    return -li_nat_to_int(li_nat_sub(y, li_nat_with_int(1))) - 1;
 }
@@ -66,10 +66,10 @@ data    : { $$ = NULL; }
 
 static li_object *cons(li_object *car, li_object *cdr)
 {
-    li_pair_t *pair = (li_pair_t *)li_pair(car, cdr);
-    pair->lineno = yylineno;
-    pair->filename = yyfilename;
-    return (li_object *)pair;
+    li_object *pair = li_cons(car, cdr);
+    if (yyfilename)
+        li_pair_set_location(pair, yyfilename, yylineno);
+    return pair;
 }
 
 static li_object *append(li_object *lst, li_object *obj)
@@ -85,7 +85,12 @@ static li_object *append(li_object *lst, li_object *obj)
 
 extern li_object *li_read(li_port_t *port)
 {
+    static int rooted = 0;
     int pop = push_buffer(port);
+    if (!rooted) {
+        li_gc_add_root(&obj);
+        rooted = 1;
+    }
     if (yyparse())
         return NULL;
     if (pop)
@@ -1,17 +1,46 @@
 #include "li.h"
+#include "li_gc.h"
 #include "li_lib.h"
 
 #include <string.h>
 
+/* How many characters apart the entries of a string's index are. */
+#define LI_STRING_INDEX_STEP 32
+
+/* Strings with fewer bytes than this keep them inline. */
+#define LI_STRING_INLINE_SIZE 24
+
+/* Where the bytes of a string kept inline start. */
+#define string_inline(str) ((char *)((str) + 1))
+
+/*
+ * Strings are immutable, so their size in bytes and length in characters are
+ * worked out once when they are made.  Characters of an ASCII string are
+ * bytes and can be looked up directly.  Others get an index of where every
+ * LI_STRING_INDEX_STEP-th character starts the first time one is looked up,
+ * after which no lookup has to decode more than that many characters.
+ *
+ * Short strings keep their bytes right after their fields, in the same slot,
+ * so making one takes a single allocation.
+ *
+ * A substring may share the bytes of the string it was taken from, its parent
+ * (see li_gc_add_slice).  Its bytes are then only followed by a NUL if it
+ * runs to the end of its parent, and li_string_bytes copies them otherwise.
+ */
 struct li_str_t {
     LI_OBJ_HEAD;
     char *bytes;
+    size_t size;
+    int length;
+    li_bool_t ascii;
+    size_t *index;
+    li_str_t *parent;
 };
 
 static void deinit(li_str_t *str)
 {
     li_string_free(str);
-    free(str);
+    free(str->index);
 }
 
 static li_object *ref(li_str_t *str, int k)
@@ -21,14 +50,14 @@ static li_object *ref(li_str_t *str, int k)
 
 static void display(li_str_t *str, li_port_t *port)
 {
-    li_port_printf(port, "%s", li_string_bytes(str));
+    li_port_printf(port, "%.*s", (int)str->size, str->bytes);
 }
 
 static void write(li_str_t *str, li_port_t *port)
 {
-    const char *bytes = li_string_bytes(str);
-    li_port_printf(port, "\"", li_string_bytes(str));
-    while (*bytes) {
+    const char *bytes = str->bytes, *end = str->bytes + str->size;
+    li_port_printf(port, "\"");
+    while (bytes < end) {
         switch (*bytes) {
         case '"':
             li_port_printf(port, "\\\"");
@@ -45,11 +74,12 @@ static void write(li_str_t *str, li_port_t *port)
         }
         bytes++;
     }
-    li_port_printf(port, "\"", li_string_bytes(str));
+    li_port_printf(port, "\"");
 }
 
 const li_type_t li_type_string = {
     .name = "string",
+    .size = sizeof(li_str_t),
     .deinit = (li_deinit_f *)deinit,
     .write = (li_write_f *)write,
     .display = (li_write_f *)display,
@@ -58,71 +88,188 @@ const li_type_t li_type_string = {
     .ref = (li_ref_f *)ref,
 };
 
-extern li_str_t *li_string_make(const char *s)
+struct li_string_builder_t {
+    LI_OBJ_HEAD;
+    char *bytes;
+    size_t size;
+    size_t cap;
+};
+
+static void string_builder_deinit(li_string_builder_t *sb)
+{
+    free(sb->bytes);
+}
+
+const li_type_t li_type_string_builder = {
+    .name = "string-builder",
+    .size = sizeof(li_string_builder_t),
+    .deinit = (li_deinit_f *)string_builder_deinit,
+};
+
+/*
+ * Makes a string with room for n bytes, followed by a NUL.  The bytes must be
+ * filled in before the string is finished with string_measure.
+ */
+static li_str_t *string_alloc(size_t n)
+{
+    li_str_t *str;
+    if (n < LI_STRING_INLINE_SIZE) {
+        str = (li_str_t *)li_create_sized(&li_type_string,
+                sizeof(li_str_t) + n + 1);
+        str->bytes = string_inline(str);
+    } else {
+        str = (li_str_t *)li_create(&li_type_string);
+        str->bytes = li_allocate(NULL, n + 1, sizeof(char));
+    }
+    str->bytes[n] = '\0';
+    str->size = n;
+    str->index = NULL;
+    str->parent = NULL;
+    return str;
+}
+
+/* Works out the length of a string from its bytes. */
+static li_str_t *string_measure(li_str_t *str)
 {
-    li_str_t *str = li_allocate(NULL, 1, sizeof(*str));
-    li_object_init((li_object *)str, &li_type_string);
-    str->bytes = strdup(s);
+    size_t i, n = str->size;
+    for (i = 0; i < n && !(str->bytes[i] & 0x80); i++)
+        ;
+    str->ascii = i == n;
+    str->length = str->ascii ? n : i + li_chr_count(str->bytes + i);
     return str;
 }
 
+/* Makes a string out of the first n bytes of s. */
+static li_str_t *string_make(const char *s, size_t n)
+{
+    li_str_t *str = string_alloc(n);
+    memcpy(str->bytes, s, n);
+    return string_measure(str);
+}
+
+static void string_index(li_str_t *str)
+{
+    const char *s = str->bytes;
+    int k;
+    str->index = li_allocate(NULL, str->length / LI_STRING_INDEX_STEP + 1,
+            sizeof(*str->index));
+    for (k = 0; k < str->length; k++) {
+        if (k % LI_STRING_INDEX_STEP == 0)
+            str->index[k / LI_STRING_INDEX_STEP] = s - str->bytes;
+        s += li_chr_decode(NULL, s);
+    }
+    if (k % LI_STRING_INDEX_STEP == 0)
+        str->index[k / LI_STRING_INDEX_STEP] = s - str->bytes;
+}
+
+/* Where in the bytes of str its kth character starts, 0 <= k <= length. */
+static size_t string_offset(li_str_t *str, int k)
+{
+    const char *s;
+    int i;
+    if (str->ascii)
+        return k;
+    if (!str->index)
+        string_index(str);
+    s = str->bytes + str->index[k / LI_STRING_INDEX_STEP];
+    for (i = k % LI_STRING_INDEX_STEP; i; i--)
+        s += li_chr_decode(NULL, s);
+    return s - str->bytes;
+}
+
+static void string_unshare(li_str_t *str)
+{
+    char *bytes;
+    if (!str->parent)
+        return;
+    bytes = li_allocate(NULL, str->size + 1, sizeof(char));
+    memcpy(bytes, str->bytes, str->size);
+    bytes[str->size] = '\0';
+    str->bytes = bytes;
+    str->parent = NULL;
+}
+
+/*
+ * Makes a string of the length characters which take up the n bytes of str
+ * starting at from, sharing them with str if there are enough of them.
+ */
+static li_str_t *string_slice(li_str_t *str, size_t from, size_t n,
+        int length)
+{
+    li_str_t *slice;
+    if (n < LI_SLICE_MIN_SIZE)
+        return string_make(str->bytes + from, n);
+    slice = (li_str_t *)li_create(&li_type_string);
+    slice->bytes = str->bytes + from;
+    slice->size = n;
+    slice->length = length;
+    slice->ascii = str->ascii;
+    slice->index = NULL;
+    slice->parent = str->parent ? str->parent : str;
+    li_gc_add_slice((li_object *)slice, (li_object *)slice->parent,
+            (li_unshare_f *)string_unshare);
+    return slice;
+}
+
+extern li_str_t *li_string_make(const char *s)
+{
+    return string_make(s, strlen(s));
+}
+
 extern li_str_t *li_string_copy(li_str_t *str, int start, int end)
 {
-    li_str_t *res;
-    char *bytes, *end_bytes;
-    if (start == 0 && end == -1)
-        return li_string_make(str->bytes);
-    if (end != -1 && start > end)
+    size_t from;
+    if (end == -1)
+        end = str->length;
+    if (start > end)
         li_error_fmt("start must be less than end");
-    if (start > li_string_length(str) || (end != -1 && end > li_string_length(str)))
+    if (start < 0 || end > str->length)
         li_error_fmt("start and end are out of range");
-    bytes = str->bytes;
-    while (start) {
-        bytes += li_chr_decode(NULL, bytes);
-        start--;
-        end--;
-    }
-    if (end < 0)
-        return li_string_make(bytes);
-    bytes = strdup(bytes);
-    end_bytes = bytes;
-    while (end--)
-        end_bytes += li_chr_decode(NULL, end_bytes);
-    *end_bytes = '\0';
-    res = li_string_make(bytes);
-    free(bytes);
-    return res;
+    from = string_offset(str, start);
+    return string_slice(str, from, string_offset(str, end) - from,
+            end - start);
 }
 
 extern void li_string_free(li_str_t *str)
 {
-    free(str->bytes);
+    if (!str->parent && str->bytes != string_inline(str))
+        free(str->bytes);
 }
 
 extern char *li_string_bytes(li_str_t *str)
 {
+    if (str->bytes[str->size])
+        string_unshare(str);
     return str->bytes;
 }
 
 extern li_character_t li_string_ref(li_str_t *str, int idx)
 {
     li_character_t c;
-    const char *s = str->bytes;
-    while (idx >= 0) {
-        s += li_chr_decode(&c, s);
-        idx--;
-    }
+    if (idx < 0 || idx >= str->length)
+        li_error_fmt("out of range: ~a", li_num_with_int(idx));
+    if (str->ascii)
+        return (li_byte_t)str->bytes[idx];
+    li_chr_decode(&c, str->bytes + string_offset(str, idx));
     return c;
 }
 
 extern int li_string_length(li_str_t *str)
 {
-    return li_chr_count(str->bytes);
+    return str->length;
+}
+
+extern size_t li_string_size(li_str_t *str)
+{
+    return str->size;
 }
 
 extern li_cmp_t li_string_cmp(li_str_t *st1, li_str_t *st2)
 {
-    int res = strcmp(st1->bytes, st2->bytes);
+    int res = memcmp(st1->bytes, st2->bytes,
+            st1->size < st2->size ? st1->size : st2->size);
+    if (!res)
+        res = (st1->size > st2->size) - (st1->size < st2->size);
     if (res < 0)
         return LI_CMP_LT;
     if (res > 0)
@@ -130,20 +277,53 @@ extern li_cmp_t li_string_cmp(li_str_t *st1, li_str_t *st2)
     return LI_CMP_EQ;
 }
 
+extern unsigned long li_string_hash(li_str_t *str)
+{
+    return li_hash_bytes(str->bytes, str->size);
+}
+
 extern li_str_t *li_string_append(li_str_t *str1, li_str_t *str2)
 {
-    int n1 = strlen(str1->bytes);
-    int n2 = strlen(str2->bytes);
-    char *s = li_allocate(NULL, n1+n2+1, sizeof(*s));
-    int i;
-    for (i = 0; i < n1; ++i)
-        s[i] = str1->bytes[i];
-    for (i = 0; i < n2; ++i)
-        s[n1+i] = str2->bytes[i];
-    s[n1+n2] = '\0';
-    str1 = li_string_make(s);
-    free(s);
-    return str1;
+    li_str_t *str = string_alloc(str1->size + str2->size);
+    memcpy(str->bytes, str1->bytes, str1->size);
+    memcpy(str->bytes + str1->size, str2->bytes, str2->size);
+    return string_measure(str);
+}
+
+extern li_string_builder_t *li_string_builder_make(void)
+{
+    li_string_builder_t *sb;
+    sb = (li_string_builder_t *)li_create(&li_type_string_builder);
+    sb->size = 0;
+    sb->cap = 16;
+    sb->bytes = li_allocate(NULL, sb->cap, sizeof(*sb->bytes));
+    return sb;
+}
+
+extern void li_string_builder_append(li_string_builder_t *sb, const char *s,
+        size_t n)
+{
+    if (sb->size + n > sb->cap) {
+        size_t cap = sb->cap;
+        while (sb->size + n > cap)
+            cap *= 2;
+        sb->bytes = li_reallocate(sb->bytes, sb->cap, cap, sizeof(*sb->bytes));
+        sb->cap = cap;
+    }
+    memcpy(sb->bytes + sb->size, s, n);
+    sb->size += n;
+}
+
+extern void li_string_builder_append_char(li_string_builder_t *sb,
+        li_character_t c)
+{
+    char buf[5];
+    li_string_builder_append(sb, buf, li_chr_encode(c, buf, sizeof(buf)));
+}
+
+extern li_str_t *li_string_builder_to_string(li_string_builder_t *sb)
+{
+    return string_make(sb->bytes, sb->size);
 }
 static li_object *p_make_string(li_object *args) {
     li_str_t *str;
@@ -184,17 +364,78 @@ static li_object *p_is_string(li_object *args) {
     return li_boolean(li_is_string(obj));
 }
 
+/*
+ * (string=? string1 string2 ...)
+ * Returns #t if all the strings are the same, #f otherwise.
+ */
+static li_object *p_string_eq(li_object *args) {
+    li_str_t *str1, *str2;
+    li_parse_args(args, "ss.", &str1, &str2, &args);
+    while (li_string_cmp(str1, str2) == LI_CMP_EQ) {
+        if (!args)
+            return li_true;
+        str1 = str2;
+        li_parse_args(args, "s.", &str2, &args);
+    }
+    return li_false;
+}
+
+/* Adds up the sizes of the strings first, to make the result in one go. */
 static li_object *p_string_append(li_object *args) {
-    li_str_t *str;
-    li_parse_args(args, "s.", &str, &args);
-    str = li_string_copy(str, 0, -1);
-    for (; args; ) {
-        li_str_t *old = str, *end;
-        li_parse_args(args, "s.", &end, &args);
-        str = li_string_append(str, end);
-        li_string_free(old);
+    li_object *lst;
+    li_str_t *str, *res;
+    size_t n = 0;
+    for (lst = args; lst; ) {
+        li_parse_args(lst, "s.", &str, &lst);
+        n += str->size;
     }
-    return (li_object *)str;
+    res = string_alloc(n);
+    for (n = 0, lst = args; lst; lst = li_cdr(lst)) {
+        str = (li_str_t *)li_car(lst);
+        memcpy(res->bytes + n, str->bytes, str->size);
+        n += str->size;
+    }
+    return (li_object *)string_measure(res);
+}
+
+static li_object *p_make_string_builder(li_object *args) {
+    li_parse_args(args, "");
+    return (li_object *)li_string_builder_make();
+}
+
+static li_object *p_is_string_builder(li_object *args) {
+    li_object *obj;
+    li_parse_args(args, "o", &obj);
+    return li_boolean(li_is_string_builder(obj));
+}
+
+/*
+ * (string-builder-append! sb obj ...)
+ * Appends each obj, a character or a string, to the string builder sb.
+ */
+static li_object *p_string_builder_append(li_object *args) {
+    li_object *sb, *obj;
+    li_parse_args(args, "o.", &sb, &args);
+    li_assert_type(string_builder, sb);
+    while (args) {
+        li_parse_args(args, "o.", &obj, &args);
+        if (li_is_character(obj))
+            li_string_builder_append_char((li_string_builder_t *)sb,
+                    li_to_character(obj));
+        else if (li_is_string(obj))
+            li_string_builder_append((li_string_builder_t *)sb,
+                    ((li_str_t *)obj)->bytes, ((li_str_t *)obj)->size);
+        else
+            li_error_fmt("not a character or string: ~s", obj);
+    }
+    return li_void;
+}
+
+static li_object *p_string_builder_to_string(li_object *args) {
+    li_object *sb;
+    li_parse_args(args, "o", &sb);
+    li_assert_type(string_builder, sb);
+    return (li_object *)li_string_builder_to_string((li_string_builder_t *)sb);
 }
 
 static li_object *p_string_to_list(li_object *args) {
@@ -215,7 +456,7 @@ static li_object *p_string_to_list(li_object *args) {
 static li_object *p_string_to_symbol(li_object *args) {
     li_str_t *str;
     li_parse_args(args, "s", &str);
-    return (li_object *)li_symbol(li_string_bytes(str));
+    return (li_object *)li_symbol_n(str->bytes, str->size);
 }
 
 static li_object *p_string_split(li_object *args)
@@ -252,7 +493,12 @@ extern void li_define_string_functions(li_env_t *env)
     lilib_defproc(env, "string", p_string);
     lilib_defproc(env, "string?", p_is_string);
     lilib_defproc(env, "string-append", p_string_append);
+    lilib_defproc(env, "string=?", p_string_eq);
     lilib_defproc(env, "string->list", p_string_to_list);
     lilib_defproc(env, "string->symbol", p_string_to_symbol);
     lilib_defproc(env, "string-split", p_string_split);
+    lilib_defproc(env, "make-string-builder", p_make_string_builder);
+    lilib_defproc(env, "string-builder?", p_is_string_builder);
+    lilib_defproc(env, "string-builder-append!", p_string_builder_append);
+    lilib_defproc(env, "string-builder->string", p_string_builder_to_string);
 }
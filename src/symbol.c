@@ -1,22 +1,77 @@
 #include "li.h"
 #include "li_lib.h"
 
+#include <stdint.h>
 #include <string.h>
 
-#define HASHSIZE    1024
+/* How many slots the symbol table starts out with, a power of two. */
+#define LI_SYMBOL_TABLE_SIZE 1024
 
-static li_sym_t *_syms[HASHSIZE] = { NULL };
+/* A 64-bit constant, written so as not to need a long long literal. */
+#define LI_U64(hi, lo)  ((uint64_t)(hi) << 32 | (uint64_t)(lo))
+
+/*
+ * Interned symbols, in an open addressing table with linear probing.  Each
+ * slot keeps the hash of its symbol next to it, so a lookup only has to
+ * follow the symbols whose hashes match.  The table is kept at most half
+ * full, and doubles when it would get fuller.
+ *
+ * The table is not a root, so symbols nothing else refers to are collected,
+ * at which point deinit takes them out of it.
+ */
+typedef struct {
+    unsigned long hash;
+    li_sym_t *sym;
+} li_symbol_slot_t;
+
+static struct {
+    li_symbol_slot_t *slots;
+    size_t cap;
+    size_t size;
+} _syms = { NULL, 0, 0 };
+
+/* Removes the symbol at slot i, moving up the ones that probed past it. */
+static void symbol_table_remove(size_t i)
+{
+    size_t mask = _syms.cap - 1, j, home;
+    for (j = (i + 1) & mask; _syms.slots[j].sym; j = (j + 1) & mask) {
+        home = _syms.slots[j].hash & mask;
+        if (((j - home) & mask) >= ((j - i) & mask)) {
+            _syms.slots[i] = _syms.slots[j];
+            i = j;
+        }
+    }
+    _syms.slots[i].sym = NULL;
+    if (!--_syms.size) {
+        free(_syms.slots);
+        _syms.slots = NULL;
+        _syms.cap = 0;
+    }
+}
+
+static void symbol_table_grow(void)
+{
+    li_symbol_slot_t *old = _syms.slots;
+    size_t cap = _syms.cap, i, j, mask;
+    _syms.cap = cap ? 2 * cap : LI_SYMBOL_TABLE_SIZE;
+    _syms.slots = li_allocate(NULL, _syms.cap, sizeof(*_syms.slots));
+    mask = _syms.cap - 1;
+    for (i = 0; i < cap; i++) {
+        if (!old[i].sym)
+            continue;
+        for (j = old[i].hash & mask; _syms.slots[j].sym; j = (j + 1) & mask)
+            ;
+        _syms.slots[j] = old[i];
+    }
+    free(old);
+}
 
 static void deinit(li_sym_t *sym)
 {
-    if (sym->next)
-        sym->next->prev = sym->prev;
-    if (sym->prev)
-        sym->prev->next = sym->next;
-    else
-        _syms[sym->hash] = sym->next;
-    free(sym->string);
-    free(sym);
+    size_t mask = _syms.cap - 1, i;
+    for (i = sym->hash & mask; _syms.slots[i].sym != sym; i = (i + 1) & mask)
+        ;
+    symbol_table_remove(i);
 }
 
 static void write(li_sym_t *obj, li_port_t *port)
@@ -26,33 +81,172 @@ static void write(li_sym_t *obj, li_port_t *port)
 
 const li_type_t li_type_symbol = {
     .name = "symbol",
+    .size = sizeof(li_sym_t),
     .deinit = (li_deinit_f *)deinit,
     .write = (li_write_f *)write,
 };
 
+static uint64_t hash_read8(const unsigned char *p)
+{
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static uint64_t hash_read4(const unsigned char *p)
+{
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+/* Multiplies a and b into a 128-bit product, leaving its halves in them. */
+static void hash_mum(uint64_t *a, uint64_t *b)
+{
+    uint64_t ha = *a >> 32, hb = *b >> 32;
+    uint64_t la = (uint32_t)*a, lb = (uint32_t)*b;
+    uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+    uint64_t t = rl + (rm0 << 32), lo, hi;
+    int c = t < rl;
+    lo = t + (rm1 << 32);
+    c += lo < t;
+    hi = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+    *a = lo;
+    *b = hi;
+}
+
+static uint64_t hash_mix(uint64_t a, uint64_t b)
+{
+    hash_mum(&a, &b);
+    return a ^ b;
+}
+
+/*
+ * wyhash (https://github.com/wangyi-fudan/wyhash), with its default seed and
+ * secret and a multiplication that does not need 128-bit integers.
+ */
+extern unsigned long li_hash_bytes(const void *bytes, size_t n)
+{
+    static const uint64_t secret[4] = {
+        LI_U64(0x2d358dcc, 0xaa6c78a5),
+        LI_U64(0x8bb84b93, 0x962eacc9),
+        LI_U64(0x4b33a62e, 0xd433d4a3),
+        LI_U64(0x4d5a2da5, 0x1de1aa47),
+    };
+    const unsigned char *p = bytes;
+    uint64_t seed = hash_mix(secret[0], secret[1]), a, b;
+    size_t i = n;
+    if (n <= 16) {
+        if (n >= 4) {
+            size_t k = (n >> 3) << 2;
+            a = hash_read4(p) << 32 | hash_read4(p + k);
+            b = hash_read4(p + n - 4) << 32 | hash_read4(p + n - 4 - k);
+        } else if (n > 0) {
+            a = (uint64_t)p[0] << 16 | (uint64_t)p[n >> 1] << 8 | p[n - 1];
+            b = 0;
+        } else {
+            a = b = 0;
+        }
+    } else {
+        if (i > 48) {
+            uint64_t seed1 = seed, seed2 = seed;
+            do {
+                seed = hash_mix(hash_read8(p) ^ secret[1],
+                        hash_read8(p + 8) ^ seed);
+                seed1 = hash_mix(hash_read8(p + 16) ^ secret[2],
+                        hash_read8(p + 24) ^ seed1);
+                seed2 = hash_mix(hash_read8(p + 32) ^ secret[3],
+                        hash_read8(p + 40) ^ seed2);
+                p += 48;
+                i -= 48;
+            } while (i > 48);
+            seed ^= seed1 ^ seed2;
+        }
+        while (i > 16) {
+            seed = hash_mix(hash_read8(p) ^ secret[1],
+                    hash_read8(p + 8) ^ seed);
+            p += 16;
+            i -= 16;
+        }
+        a = hash_read8(p + i - 16);
+        b = hash_read8(p + i - 8);
+    }
+    a ^= secret[1];
+    b ^= seed;
+    hash_mum(&a, &b);
+    return (unsigned long)hash_mix(a ^ secret[0] ^ n, b ^ secret[1]);
+}
+
 extern li_sym_t *li_symbol(const char *s)
 {
+    return li_symbol_n(s, strlen(s));
+}
+
+/*
+ * The name of a symbol is kept right after it, like the bytes of a short
+ * string, since it never changes.
+ */
+extern li_sym_t *li_symbol_n(const char *s, size_t n)
+{
+    unsigned long hash = li_hash_bytes(s, n);
     li_sym_t *sym;
-    unsigned int i, hash;
-    for (i = hash = 0; s[i]; i++)
-        hash = hash * 31 + s[i];
-    hash = hash % HASHSIZE;
-    if (_syms[hash])
-        for (sym = _syms[hash]; sym; sym = sym->next)
-            if (strcmp(li_to_symbol(sym), s) == 0)
-                return sym;
-    sym = li_allocate(NULL, 1, sizeof(*sym));
-    li_object_init((li_object *)sym, &li_type_symbol);
-    sym->string = li_strdup(s);
-    sym->prev = NULL;
-    sym->next = _syms[hash];
-    if (sym->next)
-        sym->next->prev = sym;
+    size_t mask, i;
+    if (2 * (_syms.size + 1) > _syms.cap)
+        symbol_table_grow();
+    mask = _syms.cap - 1;
+    for (i = hash & mask; (sym = _syms.slots[i].sym); i = (i + 1) & mask)
+        if (_syms.slots[i].hash == hash && sym->size == n
+                && memcmp(sym->string, s, n) == 0) {
+            li_gc_read_barrier((li_object *)sym);
+            return sym;
+        }
+    sym = (li_sym_t *)li_create_sized(&li_type_symbol,
+            sizeof(li_sym_t) + n + 1);
+    sym->string = (char *)(sym + 1);
+    memcpy(sym->string, s, n);
+    sym->string[n] = '\0';
+    sym->size = n;
     sym->hash = hash;
-    _syms[hash] = sym;
+    _syms.slots[i].hash = hash;
+    _syms.slots[i].sym = sym;
+    _syms.size++;
     return sym;
 }
 
+li_sym_t *li_sym_quote;
+li_sym_t *li_sym_quasiquote;
+li_sym_t *li_sym_unquote;
+li_sym_t *li_sym_unquote_splicing;
+li_sym_t *li_sym_if;
+li_sym_t *li_sym_else;
+li_sym_t *li_sym_arrow;
+li_sym_t *li_sym_begin;
+li_sym_t *li_sym_lambda;
+
+static const struct {
+    li_sym_t **sym;
+    const char *name;
+} _well_known[] = {
+    { &li_sym_quote,            "quote" },
+    { &li_sym_quasiquote,       "quasiquote" },
+    { &li_sym_unquote,          "unquote" },
+    { &li_sym_unquote_splicing, "unquote-splicing" },
+    { &li_sym_if,               "if" },
+    { &li_sym_else,             "else" },
+    { &li_sym_arrow,            "=>" },
+    { &li_sym_begin,            "begin" },
+    { &li_sym_lambda,           "lambda" },
+};
+
+extern void li_intern_well_known_symbols(void)
+{
+    size_t i;
+    for (i = 0; i < sizeof(_well_known) / sizeof(*_well_known); i++) {
+        *_well_known[i].sym = li_symbol(_well_known[i].name);
+        li_gc_protect((li_object *)*_well_known[i].sym);
+    }
+}
+
 /*
  * (symbol? obj)
  * Returns #t if the object is a symbol, #f otherwise.
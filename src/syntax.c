@@ -10,13 +10,13 @@ static void macro_mark(li_macro_t *mac)
 
 const li_type_t li_type_macro = {
     .name = "macro",
+    .size = sizeof(li_macro_t),
     .mark = (li_mark_f *)macro_mark,
 };
 
 extern li_object *li_macro(li_proc_obj_t *proc)
 {
-    li_macro_t *obj = li_allocate(NULL, 1, sizeof(*obj));
-    li_object_init((li_object *)obj, &li_type_macro);
+    li_macro_t *obj = (li_macro_t *)li_create(&li_type_macro);
     obj->proc = proc;
     obj->special_form = NULL;
     return (li_object *)obj;
@@ -24,8 +24,7 @@ extern li_object *li_macro(li_proc_obj_t *proc)
 
 extern li_object *li_special_form(li_special_form_t *proc)
 {
-    li_macro_t *obj = li_allocate(NULL, 1, sizeof(*obj));
-    li_object_init((li_object *)obj, &li_type_macro);
+    li_macro_t *obj = (li_macro_t *)li_create(&li_type_macro);
     obj->proc = NULL;
     obj->special_form = proc;
     return (li_object *)obj;
@@ -39,6 +38,12 @@ struct li_syntax_t {
     li_object *scopes;
 };
 
+static void syntax_mark(li_syntax_t *syn)
+{
+    li_mark(syn->e);
+    li_mark(syn->scopes);
+}
+
 static li_cmp_t syntax_compare(li_syntax_t *syn1, li_syntax_t *syn2)
 {
     if (li_is_equal(syn1->e, syn2->e) && li_is_equal(syn1->scopes, syn2->scopes))
@@ -58,11 +63,12 @@ static void syntax_write(li_syntax_t *syn, li_port_t *port)
 const li_type_t li_type_syntax = {
     .name = "syntax",
     .size = sizeof(li_syntax_t),
+    .mark = (li_mark_f *)syntax_mark,
     .compare = (li_cmp_f *)syntax_compare,
     .write = (li_write_f *)syntax_write,
 };
 
-#define li_is_syntax(x) li_is_type(x, &li_type_syntax)
+#define li_is_syntax(x) li_is_object_type(x, &li_type_syntax)
 
 static li_object *p_syntax(li_object *args)
 {
@@ -96,7 +102,7 @@ static li_object *p_is_syntax(li_object *args)
 
     li_object *obj;
     li_parse_args(args, "o", &obj);
-    return li_boolean(li_is_type(obj, &li_type_syntax));
+    return li_boolean(li_is_syntax(obj));
 }
 
 extern void li_init_syntax(li_env_t *env)
@@ -14,14 +14,14 @@ static li_object *proc(li_object *args)
 
 const li_type_t li_type_type = {
     .name = "type",
+    .size = sizeof(li_type_obj_t),
     .write = (li_write_f *)write,
     .proc = proc,
 };
 
 extern li_object *li_type_obj(const li_type_t *type)
 {
-    li_type_obj_t *obj = li_allocate(NULL, 1, sizeof(*obj));
-    li_object_init((li_object *)obj, &li_type_type);
+    li_type_obj_t *obj = (li_type_obj_t *)li_create(&li_type_type);
     obj->val = type;
     return (li_object *)obj;
 }
@@ -85,8 +85,12 @@ struct accept_range {
 extern size_t li_chr_decode(li_character_t *chr, const char *s)
 {
     size_t sz, i;
-    size_t n = strlen(s);
+    size_t n;
     struct accept_range accept;
+    /* No sequence is longer than four bytes, so there is no need to look at
+     * the whole rest of s. */
+    for (n = 0; n < 4 && s[n]; n++)
+        ;
     if (n < 1) {
         if (chr)
             *chr = LI_RUNE_ERROR;
@@ -1,16 +1,37 @@
 #include "li.h"
+#include "li_gc.h"
 #include "li_lib.h"
 
+#include <string.h> /* memcpy */
+
+/*
+ * A copy of part of a vector may share its data, see li_gc_add_slice.  Such a
+ * slice knows its parent, and the parent knows it is shared, so that whichever
+ * is set first stops sharing.
+ */
 struct li_vector_t {
     LI_OBJ_HEAD;
     li_object **data;
     int length;
+    li_vector_t *parent;
+    li_bool_t shared;
 };
 
 static void deinit(li_vector_t *vec)
 {
-    free(vec->data);
-    free(vec);
+    if (!vec->parent)
+        free(vec->data);
+}
+
+static void vector_unshare(li_vector_t *vec)
+{
+    li_object **data;
+    if (!vec->parent)
+        return;
+    data = li_allocate(NULL, vec->length, sizeof(*data));
+    memcpy(data, vec->data, vec->length * sizeof(*data));
+    vec->data = data;
+    vec->parent = NULL;
 }
 
 static void vector_mark(li_vector_t *vec)
@@ -44,6 +65,13 @@ extern li_object *li_vector_ref(li_vector_t *vec, int k)
 
 extern void li_vector_set(li_vector_t *vec, int k, li_object *obj)
 {
+    if (vec->parent) {
+        vector_unshare(vec);
+    } else if (vec->shared) {
+        li_gc_unshare_slices((li_object *)vec);
+        vec->shared = LI_FALSE;
+    }
+    li_gc_write_barrier((li_object *)vec, vec->data[k]);
     vec->data[k] = obj;
 }
 
@@ -66,6 +94,8 @@ extern li_object *li_vector(li_object *lst)
     vec = (li_vector_t *)li_create(&li_type_vector);
     vec->data = li_allocate(NULL, i, sizeof(*vec->data));
     vec->length = i;
+    vec->parent = NULL;
+    vec->shared = LI_FALSE;
     for (i = 0; i < vec->length; ++i, lst = li_cdr(lst))
         vec->data[i] = li_car(lst);
     return (li_object *)vec;
@@ -73,10 +103,11 @@ extern li_object *li_vector(li_object *lst)
 
 extern li_vector_t *li_make_vector(int k, li_object *fill)
 {
-    li_vector_t *vec = li_allocate(NULL, 1, sizeof(*vec));
-    li_object_init((li_object *)vec, &li_type_vector);
+    li_vector_t *vec = (li_vector_t *)li_create(&li_type_vector);
     vec->data = li_allocate(NULL, k, sizeof(*vec->data));
     vec->length = k;
+    vec->parent = NULL;
+    vec->shared = LI_FALSE;
     while (--k >= 0)
         li_vector_set(vec, k, fill);
     return vec;
@@ -272,12 +303,34 @@ static li_vector_t *vector_copy(
     return to;
 }
 
+/* Copies the elements of vec from start to end, sharing them if there are
+ * enough of them. */
+static li_vector_t *vector_slice(li_vector_t *vec, int start, int end)
+{
+    li_vector_t *slice;
+    if (end < 0)
+        end = li_vector_length(vec);
+    if (start > end || end > li_vector_length(vec))
+        li_error_fmt("start and end are out of range");
+    if ((end - start) * sizeof(*vec->data) < LI_SLICE_MIN_SIZE)
+        return vector_copy(NULL, 0, vec, start, end);
+    slice = (li_vector_t *)li_create(&li_type_vector);
+    slice->data = vec->data + start;
+    slice->length = end - start;
+    slice->parent = vec->parent ? vec->parent : vec;
+    slice->shared = LI_FALSE;
+    slice->parent->shared = LI_TRUE;
+    li_gc_add_slice((li_object *)slice, (li_object *)slice->parent,
+            (li_unshare_f *)vector_unshare);
+    return slice;
+}
+
 static li_object *p_vector_copy(li_object *args)
 {
     li_vector_t *vec;
     int start = 0, end = -1;
     li_parse_args(args, "v?kk", &vec, &start, &end);
-    return (li_object *)vector_copy(NULL, 0, vec, start, end);
+    return (li_object *)vector_slice(vec, start, end);
 }
 
 /**
@@ -0,0 +1,489 @@
+#include "li.h"
+#include "li_lib.h"
+
+/*
+ * Neither weak boxes nor ephemerons have a mark function, and guardians only
+ * mark what they queued: the collector looks after the rest itself once
+ * marking is over (see li_gc_weak).
+ */
+
+static void weak_box_write(li_weak_box_t *box, li_port_t *port)
+{
+    li_port_printf(port, box->broken ? "#[weak-box broken]" : "#[weak-box]");
+}
+
+const li_type_t li_type_weak_box = {
+    .name = "weak-box",
+    .size = sizeof(li_weak_box_t),
+    .write = (li_write_f *)weak_box_write,
+};
+
+extern li_weak_box_t *li_weak_box(li_object *value)
+{
+    li_weak_box_t *box = (li_weak_box_t *)li_create(&li_type_weak_box);
+    box->value = value;
+    box->broken = LI_FALSE;
+    li_gc_register_weak((li_object *)box);
+    return box;
+}
+
+extern li_object *li_weak_box_value(li_weak_box_t *box)
+{
+    li_gc_read_barrier(box->value);
+    return box->value;
+}
+
+static void ephemeron_write(li_ephemeron_t *eph, li_port_t *port)
+{
+    li_port_printf(port,
+            eph->broken ? "#[ephemeron broken]" : "#[ephemeron]");
+}
+
+const li_type_t li_type_ephemeron = {
+    .name = "ephemeron",
+    .size = sizeof(li_ephemeron_t),
+    .write = (li_write_f *)ephemeron_write,
+};
+
+extern li_ephemeron_t *li_ephemeron(li_object *key, li_object *datum)
+{
+    li_ephemeron_t *eph = (li_ephemeron_t *)li_create(&li_type_ephemeron);
+    eph->key = key;
+    eph->datum = datum;
+    eph->broken = LI_FALSE;
+    li_gc_register_weak((li_object *)eph);
+    return eph;
+}
+
+extern li_object *li_ephemeron_key(li_ephemeron_t *eph)
+{
+    li_gc_read_barrier(eph->key);
+    return eph->key;
+}
+
+extern li_object *li_ephemeron_datum(li_ephemeron_t *eph)
+{
+    li_gc_read_barrier(eph->datum);
+    return eph->datum;
+}
+
+static void guardian_mark(li_guardian_t *guardian)
+{
+    size_t i;
+    for (i = 0; i < guardian->num_ready; i++)
+        li_mark(guardian->ready[i]);
+}
+
+static void guardian_deinit(li_guardian_t *guardian)
+{
+    free(guardian->pending);
+    free(guardian->ready);
+}
+
+static void guardian_write(li_guardian_t *guardian, li_port_t *port)
+{
+    (void)guardian;
+    li_port_printf(port, "#[guardian]");
+}
+
+const li_type_t li_type_guardian = {
+    .name = "guardian",
+    .size = sizeof(li_guardian_t),
+    .mark = (li_mark_f *)guardian_mark,
+    .deinit = (li_deinit_f *)guardian_deinit,
+    .write = (li_write_f *)guardian_write,
+};
+
+extern li_guardian_t *li_guardian(void)
+{
+    li_guardian_t *guardian;
+    guardian = (li_guardian_t *)li_create(&li_type_guardian);
+    guardian->pending = guardian->ready = NULL;
+    guardian->num_pending = guardian->cap_pending = 0;
+    guardian->num_ready = guardian->cap_ready = 0;
+    li_gc_register_weak((li_object *)guardian);
+    return guardian;
+}
+
+extern void li_guardian_register(li_guardian_t *guardian, li_object *obj)
+{
+    if (guardian->num_pending == guardian->cap_pending) {
+        guardian->cap_pending = guardian->cap_pending
+            ? LI_INC_CAP(guardian->cap_pending) : 16;
+        guardian->pending = li_reallocate(guardian->pending,
+                guardian->num_pending, guardian->cap_pending, sizeof(*guardian->pending));
+    }
+    guardian->pending[guardian->num_pending++] = obj;
+}
+
+extern li_object *li_guardian_poll(li_guardian_t *guardian)
+{
+    li_object *obj;
+    if (!guardian->num_ready)
+        return NULL;
+    obj = guardian->ready[--guardian->num_ready];
+    /* The guardian may not have been traced yet. */
+    li_gc_write_barrier((li_object *)guardian, obj);
+    return obj;
+}
+
+/*
+ * Weak hash tables map keys to values by identity, holding on to each value
+ * only as long as its key is reachable from elsewhere.  Every entry is an
+ * ephemeron, kept on a list per bucket; broken entries are dropped whenever
+ * their bucket is updated.  Objects never move, so a key's address is a
+ * stable hash.
+ */
+
+typedef struct {
+    LI_OBJ_HEAD;
+    li_object **buckets;
+    size_t size;
+    size_t count;   /* entries, some of which may be broken */
+} li_weak_table_t;
+
+static void weak_table_mark(li_weak_table_t *table)
+{
+    size_t i;
+    for (i = 0; i < table->size; i++)
+        li_mark(table->buckets[i]);
+}
+
+static void weak_table_deinit(li_weak_table_t *table)
+{
+    free(table->buckets);
+}
+
+static void weak_table_write(li_weak_table_t *table, li_port_t *port)
+{
+    (void)table;
+    li_port_printf(port, "#[weak-hash-table]");
+}
+
+const li_type_t li_type_weak_table = {
+    .name = "weak-hash-table",
+    .size = sizeof(li_weak_table_t),
+    .mark = (li_mark_f *)weak_table_mark,
+    .deinit = (li_deinit_f *)weak_table_deinit,
+    .write = (li_write_f *)weak_table_write,
+};
+
+#define li_is_weak_table(obj)   li_is_object_type(obj, &li_type_weak_table)
+
+static size_t li_weak_table_bucket(li_weak_table_t *table, li_object *key)
+{
+    return ((size_t)key >> 3) * 2654435761u % table->size;
+}
+
+static void li_weak_table_store(li_weak_table_t *table, size_t i,
+        li_object *lst)
+{
+    li_gc_write_barrier((li_object *)table, table->buckets[i]);
+    table->buckets[i] = lst;
+}
+
+/* Unlinks the broken entries of the ith bucket. */
+static void li_weak_table_prune(li_weak_table_t *table, size_t i)
+{
+    li_object *prev = NULL, *iter;
+    for (iter = table->buckets[i]; iter; iter = li_cdr(iter)) {
+        if (!((li_ephemeron_t *)li_car(iter))->broken) {
+            prev = iter;
+            continue;
+        }
+        if (prev)
+            li_set_cdr(prev, li_cdr(iter));
+        else
+            li_weak_table_store(table, i, li_cdr(iter));
+        table->count--;
+    }
+}
+
+static li_ephemeron_t *li_weak_table_find(li_weak_table_t *table,
+        li_object *key)
+{
+    li_object *iter;
+    iter = table->buckets[li_weak_table_bucket(table, key)];
+    for (; iter; iter = li_cdr(iter)) {
+        li_ephemeron_t *eph = (li_ephemeron_t *)li_car(iter);
+        if (!eph->broken && eph->key == key)
+            return eph;
+    }
+    return NULL;
+}
+
+static void li_weak_table_resize(li_weak_table_t *table, size_t size)
+{
+    li_object **buckets = table->buckets, *iter;
+    size_t old_size = table->size, i, j;
+    table->buckets = li_allocate(NULL, size, sizeof(*table->buckets));
+    table->size = size;
+    table->count = 0;
+    for (i = 0; i < old_size; i++) {
+        /* The old lists are dropped, which the barrier needs to know. */
+        li_gc_write_barrier((li_object *)table, buckets[i]);
+        for (iter = buckets[i]; iter; iter = li_cdr(iter)) {
+            li_ephemeron_t *eph = (li_ephemeron_t *)li_car(iter);
+            if (eph->broken)
+                continue;
+            j = li_weak_table_bucket(table, eph->key);
+            table->buckets[j] = li_cons((li_object *)eph, table->buckets[j]);
+            table->count++;
+        }
+    }
+    free(buckets);
+}
+
+static li_object *li_weak_table(void)
+{
+    li_weak_table_t *table;
+    table = (li_weak_table_t *)li_create(&li_type_weak_table);
+    table->size = 16;
+    table->buckets = li_allocate(NULL, table->size, sizeof(*table->buckets));
+    table->count = 0;
+    return (li_object *)table;
+}
+
+/*
+ * (make-weak-box obj)
+ * Returns a weak box holding obj, which does not keep obj alive.
+ */
+static li_object *p_make_weak_box(li_object *args)
+{
+    li_object *obj;
+    li_parse_args(args, "o", &obj);
+    return (li_object *)li_weak_box(obj);
+}
+
+static li_object *p_is_weak_box(li_object *args)
+{
+    li_object *obj;
+    li_parse_args(args, "o", &obj);
+    return li_boolean(li_is_weak_box(obj));
+}
+
+/*
+ * (weak-box-value box)
+ * (weak-box-value box default)
+ * Returns the object held by the box, or default, #f unless given, if it was
+ * collected.
+ */
+static li_object *p_weak_box_value(li_object *args)
+{
+    li_object *box, *def = li_false;
+    li_parse_args(args, "o?o", &box, &def);
+    li_assert_type(weak_box, box);
+    if (((li_weak_box_t *)box)->broken)
+        return def;
+    return li_weak_box_value((li_weak_box_t *)box);
+}
+
+/*
+ * (make-ephemeron key datum)
+ * Returns an ephemeron which keeps datum alive for as long as key is
+ * reachable from anything but the ephemeron's datum.  Once key is collected,
+ * the ephemeron is broken and lets go of both.  As in SRFI 124.
+ */
+static li_object *p_make_ephemeron(li_object *args)
+{
+    li_object *key, *datum;
+    li_parse_args(args, "oo", &key, &datum);
+    return (li_object *)li_ephemeron(key, datum);
+}
+
+static li_object *p_is_ephemeron(li_object *args)
+{
+    li_object *obj;
+    li_parse_args(args, "o", &obj);
+    return li_boolean(li_is_ephemeron(obj));
+}
+
+static li_object *p_is_ephemeron_broken(li_object *args)
+{
+    li_object *eph;
+    li_parse_args(args, "o", &eph);
+    li_assert_type(ephemeron, eph);
+    return li_boolean(((li_ephemeron_t *)eph)->broken);
+}
+
+static li_object *p_ephemeron_key(li_object *args)
+{
+    li_object *eph;
+    li_parse_args(args, "o", &eph);
+    li_assert_type(ephemeron, eph);
+    return li_ephemeron_key((li_ephemeron_t *)eph);
+}
+
+static li_object *p_ephemeron_datum(li_object *args)
+{
+    li_object *eph;
+    li_parse_args(args, "o", &eph);
+    li_assert_type(ephemeron, eph);
+    return li_ephemeron_datum((li_ephemeron_t *)eph);
+}
+
+/*
+ * (reference-barrier obj)
+ * Keeps obj alive until this call, which in an interpreter it already is.
+ */
+static li_object *p_reference_barrier(li_object *args)
+{
+    li_object *obj;
+    li_parse_args(args, "o", &obj);
+    return li_void;
+}
+
+/*
+ * (make-guardian)
+ * Returns a new guardian.
+ */
+static li_object *p_make_guardian(li_object *args)
+{
+    li_parse_args(args, "");
+    return (li_object *)li_guardian();
+}
+
+static li_object *p_is_guardian(li_object *args)
+{
+    li_object *obj;
+    li_parse_args(args, "o", &obj);
+    return li_boolean(li_is_guardian(obj));
+}
+
+/*
+ * (guardian-register! guardian obj)
+ * Asks guardian to queue obj once nothing else refers to it.  An object may
+ * be registered more than once, and is then queued as many times.
+ */
+static li_object *p_guardian_register(li_object *args)
+{
+    li_object *guardian, *obj;
+    li_parse_args(args, "oo", &guardian, &obj);
+    li_assert_type(guardian, guardian);
+    li_guardian_register((li_guardian_t *)guardian, obj);
+    return li_void;
+}
+
+/*
+ * (guardian-poll guardian)
+ * Returns the next object guardian queued, or #f if there is none.
+ */
+static li_object *p_guardian_poll(li_object *args)
+{
+    li_object *guardian, *obj;
+    li_parse_args(args, "o", &guardian);
+    li_assert_type(guardian, guardian);
+    if (!(obj = li_guardian_poll((li_guardian_t *)guardian)))
+        return li_false;
+    return obj;
+}
+
+static li_object *p_make_weak_hash_table(li_object *args)
+{
+    li_parse_args(args, "");
+    return li_weak_table();
+}
+
+static li_object *p_is_weak_hash_table(li_object *args)
+{
+    li_object *obj;
+    li_parse_args(args, "o", &obj);
+    return li_boolean(li_is_weak_table(obj));
+}
+
+/*
+ * (weak-hash-table-ref table key)
+ * (weak-hash-table-ref table key default)
+ * Returns the value key, compared with eq?, maps to, or default, #f unless
+ * given, if there is none.
+ */
+static li_object *p_weak_hash_table_ref(li_object *args)
+{
+    li_object *table, *key, *def = li_false;
+    li_ephemeron_t *eph;
+    li_parse_args(args, "oo?o", &table, &key, &def);
+    li_assert_type(weak_table, table);
+    if (!(eph = li_weak_table_find((li_weak_table_t *)table, key)))
+        return def;
+    return li_ephemeron_datum(eph);
+}
+
+static li_object *p_weak_hash_table_set(li_object *args)
+{
+    li_object *obj, *key, *value;
+    li_weak_table_t *table;
+    li_ephemeron_t *eph;
+    size_t i;
+    li_parse_args(args, "ooo", &obj, &key, &value);
+    li_assert_type(weak_table, obj);
+    table = (li_weak_table_t *)obj;
+    i = li_weak_table_bucket(table, key);
+    li_weak_table_prune(table, i);
+    if ((eph = li_weak_table_find(table, key))) {
+        li_gc_write_barrier((li_object *)eph, eph->datum);
+        eph->datum = value;
+        return li_void;
+    }
+    eph = li_ephemeron(key, value);
+    li_weak_table_store(table, i, li_cons((li_object *)eph, table->buckets[i]));
+    if (++table->count > 2 * table->size)
+        li_weak_table_resize(table, 2 * table->size);
+    return li_void;
+}
+
+static li_object *p_weak_hash_table_delete(li_object *args)
+{
+    li_object *obj, *key;
+    li_weak_table_t *table;
+    li_ephemeron_t *eph;
+    li_parse_args(args, "oo", &obj, &key);
+    li_assert_type(weak_table, obj);
+    table = (li_weak_table_t *)obj;
+    if ((eph = li_weak_table_find(table, key))) {
+        /* Breaking the entry by hand lets the prune unlink it. */
+        eph->key = eph->datum = li_false;
+        eph->broken = LI_TRUE;
+        li_weak_table_prune(table, li_weak_table_bucket(table, key));
+    }
+    return li_void;
+}
+
+/*
+ * (weak-hash-table-count table)
+ * Returns the number of entries whose key is still alive.
+ */
+static li_object *p_weak_hash_table_count(li_object *args)
+{
+    li_object *obj;
+    li_weak_table_t *table;
+    size_t i;
+    li_parse_args(args, "o", &obj);
+    li_assert_type(weak_table, obj);
+    table = (li_weak_table_t *)obj;
+    for (i = 0; i < table->size; i++)
+        li_weak_table_prune(table, i);
+    return (li_object *)li_num_with_int(table->count);
+}
+
+extern void li_define_weak_functions(li_env_t *env)
+{
+    lilib_defproc(env, "make-weak-box", p_make_weak_box);
+    lilib_defproc(env, "weak-box?", p_is_weak_box);
+    lilib_defproc(env, "weak-box-value", p_weak_box_value);
+    lilib_defproc(env, "make-ephemeron", p_make_ephemeron);
+    lilib_defproc(env, "ephemeron?", p_is_ephemeron);
+    lilib_defproc(env, "ephemeron-broken?", p_is_ephemeron_broken);
+    lilib_defproc(env, "ephemeron-key", p_ephemeron_key);
+    lilib_defproc(env, "ephemeron-datum", p_ephemeron_datum);
+    lilib_defproc(env, "reference-barrier", p_reference_barrier);
+    lilib_defproc(env, "make-guardian", p_make_guardian);
+    lilib_defproc(env, "guardian?", p_is_guardian);
+    lilib_defproc(env, "guardian-register!", p_guardian_register);
+    lilib_defproc(env, "guardian-poll", p_guardian_poll);
+    lilib_defproc(env, "make-weak-hash-table", p_make_weak_hash_table);
+    lilib_defproc(env, "weak-hash-table?", p_is_weak_hash_table);
+    lilib_defproc(env, "weak-hash-table-ref", p_weak_hash_table_ref);
+    lilib_defproc(env, "weak-hash-table-set!", p_weak_hash_table_set);
+    lilib_defproc(env, "weak-hash-table-delete!", p_weak_hash_table_delete);
+    lilib_defproc(env, "weak-hash-table-count", p_weak_hash_table_count);
+}